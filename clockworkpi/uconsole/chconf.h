@@ -0,0 +1,8 @@
+#pragma once
+
+// Periodic system tick: power.c sleeps with WFI when idle and counts on the
+// tick to end every sleep, see power.h
+#undef CH_CFG_ST_TIMEDELTA
+#define CH_CFG_ST_TIMEDELTA 0
+
+#include_next <chconf.h>
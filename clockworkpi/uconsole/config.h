@@ -2,4 +2,19 @@
 
 #include_next <config.h>
 
-#define BACKLIGHT_LEVELS 2
+#define BACKLIGHT_LEVELS 8
+#define BACKLIGHT_BREATHING
+
+/* Advertise a wheel resolution multiplier so wheel mode can scroll by less
+ * than a detent; see trackball_scroll_toggle() for hosts without support */
+#define POINTING_DEVICE_HIRES_SCROLL_ENABLE
+#define WHEEL_EXTENDED_REPORT
+
+#ifdef SOF_SYNC_ENABLE
+/* sof_sync.c already paces the pointing report to one per frame; a time
+ * throttle on top would drop whole frames whenever it skips the slot pass */
+#define POINTING_DEVICE_TASK_THROTTLE_MS 0
+#endif
+
+/* Size of kb_datablock_t (kb_config.h): custom trackball curve and tuning */
+#define EECONFIG_KB_DATA_SIZE 156
@@ -0,0 +1,144 @@
+#include "quantum.h"
+#include "debounce.h"
+#include "debounce_adaptive.h"
+
+#ifdef DEBOUNCE_ADAPTIVE
+
+_Static_assert(DEBOUNCE_ADAPT_MIN_MS >= 1 && DEBOUNCE_ADAPT_MIN_MS <= DEBOUNCE_ADAPT_MAX_MS, "bad debounce window bounds");
+_Static_assert(DEBOUNCE_ADAPT_MAX_MS < 255 && DEBOUNCE_ADAPT_CHATTER_MS < 255, "debounce times must fit in a byte");
+
+typedef struct {
+    uint8_t  window;        // current release window, ms
+    uint8_t  timer;         // ms left on a pending release, 0 = none
+    uint8_t  since_release; // ms since the last reported release, saturating
+    uint8_t  clean;         // bounce-free presses since the last adjustment
+    bool     bounced;       // the current press bounced at least once
+    uint16_t bounces;       // raw edges absorbed by the window
+    uint16_t chatter;       // presses that got through as chatter
+} debounce_key_t;
+
+static debounce_key_t keys[MATRIX_ROWS][MATRIX_COLS];
+static uint16_t       last_time;
+static uint8_t        active; // keys with a pending release or a recent one
+
+static inline uint8_t window_clamp(int16_t ms) {
+    if (ms < DEBOUNCE_ADAPT_MIN_MS) return DEBOUNCE_ADAPT_MIN_MS;
+    if (ms > DEBOUNCE_ADAPT_MAX_MS) return DEBOUNCE_ADAPT_MAX_MS;
+    return (uint8_t)ms;
+}
+
+void debounce_init(void) {
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+            keys[r][c] = (debounce_key_t){.window = window_clamp(DEBOUNCE), .since_release = UINT8_MAX};
+        }
+    }
+    last_time = timer_read();
+    active    = 0;
+}
+
+// The key was let go for its whole window: adapt, then report the release
+static void debounce_release(debounce_key_t *k) {
+    if (k->bounced) {
+        k->clean = 0;
+    } else if (++k->clean >= DEBOUNCE_ADAPT_CLEAN_PRESSES) {
+        k->clean  = 0;
+        k->window = window_clamp(k->window - 1);
+    }
+    k->bounced       = false;
+    k->since_release = 0;
+}
+
+// A press right after a release: the release was a bounce the window missed
+static void debounce_press(debounce_key_t *k) {
+    if (k->since_release < DEBOUNCE_ADAPT_CHATTER_MS) {
+        if (k->chatter < UINT16_MAX) k->chatter++;
+        k->window = window_clamp(k->window + DEBOUNCE_ADAPT_GROW_MS);
+        k->clean  = 0;
+    }
+    k->since_release = UINT8_MAX;
+}
+
+bool debounce(matrix_row_t raw[], matrix_row_t cooked[], bool changed) {
+    const uint16_t now     = timer_read();
+    const uint16_t diff    = TIMER_DIFF_16(now, last_time);
+    const uint8_t  elapsed = diff > UINT8_MAX ? UINT8_MAX : (uint8_t)diff;
+    last_time              = now;
+
+    if (!changed && !active) return false;
+
+    bool cooked_changed = false;
+    active              = 0;
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        matrix_row_t row = cooked[r];
+        for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+            debounce_key_t    *k    = &keys[r][c];
+            const matrix_row_t mask = (matrix_row_t)1 << c;
+            const bool         on   = raw[r] & mask;
+
+            if (row & mask) {
+                if (on) {
+                    if (k->timer) {
+                        // Back on before the window ran out
+                        k->timer   = 0;
+                        k->bounced = true;
+                        if (k->bounces < UINT16_MAX) k->bounces++;
+                    }
+                    continue;
+                }
+                if (!k->timer) {
+                    k->timer = k->window;
+                } else if (k->timer > elapsed) {
+                    k->timer -= elapsed;
+                } else {
+                    k->timer = 0;
+                    row &= ~mask;
+                    debounce_release(k);
+                }
+            } else {
+                if (k->since_release < UINT8_MAX) {
+                    k->since_release = (UINT8_MAX - k->since_release > elapsed) ? k->since_release + elapsed : UINT8_MAX;
+                }
+                if (on) {
+                    row |= mask;
+                    debounce_press(k);
+                }
+            }
+            if (k->timer || k->since_release < DEBOUNCE_ADAPT_CHATTER_MS) active++;
+        }
+        if (row != cooked[r]) {
+            cooked[r]      = row;
+            cooked_changed = true;
+        }
+    }
+    return cooked_changed;
+}
+
+void debounce_stats_reset(void) {
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+            keys[r][c].bounces = 0;
+            keys[r][c].chatter = 0;
+        }
+    }
+}
+
+void debounce_stats_print(void) {
+    uint8_t  min = UINT8_MAX, max = 0;
+    uint32_t bounces = 0, chatter = 0;
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+            const debounce_key_t *k = &keys[r][c];
+            if (k->window < min) min = k->window;
+            if (k->window > max) max = k->window;
+            bounces += k->bounces;
+            chatter += k->chatter;
+            if (k->bounces || k->chatter) {
+                uprintf("debounce r%u c%u: window %u ms, bounces %u, chatter %u\n", r, c, k->window, k->bounces, k->chatter);
+            }
+        }
+    }
+    uprintf("debounce: windows %u-%u ms, bounces %lu, chatter %lu\n", min, max, (unsigned long)bounces, (unsigned long)chatter);
+}
+
+#endif
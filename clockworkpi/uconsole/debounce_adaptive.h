@@ -0,0 +1,45 @@
+#pragma once
+
+/*
+ * Per-key adaptive debounce, the default DEBOUNCE_ALGORITHM in rules.mk.
+ *
+ * Presses are reported on the first raw edge; a release is reported once the
+ * key has read released for its own window. Every key starts at DEBOUNCE ms
+ * and moves within [DEBOUNCE_ADAPT_MIN_MS, DEBOUNCE_ADAPT_MAX_MS]:
+ *
+ * - a press that follows a reported release by less than
+ *   DEBOUNCE_ADAPT_CHATTER_MS is chatter the window let through, and widens
+ *   the window by DEBOUNCE_ADAPT_GROW_MS;
+ * - DEBOUNCE_ADAPT_CLEAN_PRESSES presses in a row without a single bounce
+ *   shrink it by 1 ms.
+ *
+ * Healthy switches settle at the minimum and release sooner; worn ones grow
+ * until their chatter is absorbed. Windows are not persisted and relearn
+ * after a power cycle. debounce_stats_print() lists the keys that bounced.
+ */
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+#ifndef DEBOUNCE_ADAPT_MIN_MS
+#    define DEBOUNCE_ADAPT_MIN_MS 2
+#endif
+#ifndef DEBOUNCE_ADAPT_MAX_MS
+#    define DEBOUNCE_ADAPT_MAX_MS 25
+#endif
+#ifndef DEBOUNCE_ADAPT_GROW_MS
+#    define DEBOUNCE_ADAPT_GROW_MS 3
+#endif
+#ifndef DEBOUNCE_ADAPT_CHATTER_MS
+#    define DEBOUNCE_ADAPT_CHATTER_MS 30
+#endif
+#ifndef DEBOUNCE_ADAPT_CLEAN_PRESSES
+#    define DEBOUNCE_ADAPT_CLEAN_PRESSES 64
+#endif
+
+#ifdef DEBOUNCE_ADAPTIVE
+void debounce_stats_reset(void);
+void debounce_stats_print(void);
+#else
+static inline void debounce_stats_reset(void) {}
+static inline void debounce_stats_print(void) {}
+#endif
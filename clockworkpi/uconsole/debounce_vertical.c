@@ -0,0 +1,96 @@
+/*
+ * Bit-parallel debounce (DEBOUNCE_ALGORITHM = vertical in rules.mk).
+ *
+ * Same semantics as the adaptive debounce with a fixed window: a press is
+ * reported on its first raw edge, a release once the key has read released
+ * for DEBOUNCE ms. Instead of a counter per key, each row keeps vertical
+ * counters: bit plane b holds bit b of every column's release counter, so
+ * one pass of word-wide AND/XOR steps counts all columns of a row at once.
+ * The elapsed time is added in one ripple-carry pass over the planes, so the
+ * cost per row is the same whether one key or all of them are settling and
+ * however many milliseconds passed since the last scan.
+ */
+#include "quantum.h"
+#include "debounce.h"
+
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+#define VC_PLANES 4
+_Static_assert(DEBOUNCE >= 1 && DEBOUNCE < (1 << VC_PLANES), "DEBOUNCE does not fit the vertical counters");
+
+static matrix_row_t counters[MATRIX_ROWS][VC_PLANES];
+static matrix_row_t pending[MATRIX_ROWS]; // released on the raw matrix, still pressed in cooked
+static uint16_t     last_time;
+
+void debounce_init(void) {
+    memset(counters, 0, sizeof(counters));
+    memset(pending, 0, sizeof(pending));
+    last_time = timer_read();
+}
+
+// Columns of the row whose counter equals DEBOUNCE
+static inline matrix_row_t counters_done(const matrix_row_t cnt[VC_PLANES]) {
+    matrix_row_t done = (matrix_row_t)~0;
+    for (uint8_t b = 0; b < VC_PLANES; b++) {
+        done &= (DEBOUNCE >> b & 1) ? cnt[b] : (matrix_row_t)~cnt[b];
+    }
+    return done;
+}
+
+// Adds ticks (at most DEBOUNCE) to the counters of the inc columns, saturating at DEBOUNCE
+static inline void counters_add(matrix_row_t cnt[VC_PLANES], matrix_row_t inc, uint16_t ticks) {
+    matrix_row_t sum[VC_PLANES];
+    matrix_row_t carry = 0;
+    for (uint8_t b = 0; b < VC_PLANES; b++) {
+        const matrix_row_t add = (ticks >> b & 1) ? inc : 0;
+        sum[b]                 = cnt[b] ^ add ^ carry;
+        carry                  = (cnt[b] & add) | (carry & (cnt[b] ^ add));
+    }
+
+    // Columns past DEBOUNCE, found from the top plane down; a carry out of
+    // the top plane is past it too
+    matrix_row_t above = carry, equal = (matrix_row_t)~0;
+    for (uint8_t b = VC_PLANES; b-- > 0;) {
+        const matrix_row_t limit = (DEBOUNCE >> b & 1) ? (matrix_row_t)~0 : 0;
+        above |= equal & sum[b] & ~limit;
+        equal &= ~(sum[b] ^ limit);
+    }
+    for (uint8_t b = 0; b < VC_PLANES; b++) {
+        cnt[b] = (sum[b] & ~above) | ((DEBOUNCE >> b & 1) ? above : 0);
+    }
+}
+
+bool debounce(matrix_row_t raw[], matrix_row_t cooked[], bool changed) {
+    const uint16_t now   = timer_read();
+    uint16_t       ticks = TIMER_DIFF_16(now, last_time);
+    last_time            = now;
+    if (ticks > DEBOUNCE) ticks = DEBOUNCE;
+
+    bool cooked_changed = false;
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        if (!changed && !pending[r]) continue;
+
+        matrix_row_t *cnt = counters[r];
+        // Counting keys advance by the elapsed time; keys that only started
+        // releasing on this scan begin at zero
+        counters_add(cnt, pending[r], ticks);
+
+        matrix_row_t row      = cooked[r];
+        const matrix_row_t up = pending[r] & ~raw[r] & counters_done(cnt);
+        row = (row | raw[r]) & ~up;
+
+        // Anything not (still) releasing restarts from zero
+        pending[r] = row & ~raw[r];
+        for (uint8_t b = 0; b < VC_PLANES; b++) {
+            cnt[b] &= pending[r];
+        }
+
+        if (row != cooked[r]) {
+            cooked[r]      = row;
+            cooked_changed = true;
+        }
+    }
+    return cooked_changed;
+}
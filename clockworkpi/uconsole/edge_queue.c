@@ -0,0 +1,54 @@
+#include "quantum.h"
+#include "edge_queue.h"
+
+#if (EDGE_QUEUE_SIZE & (EDGE_QUEUE_SIZE - 1)) != 0
+#    error "EDGE_QUEUE_SIZE must be a power of two"
+#endif
+
+#if defined(STM32_IRQ_EXTI5_9_PRIORITY) && defined(STM32_IRQ_EXTI10_15_PRIORITY)
+#    if STM32_IRQ_EXTI5_9_PRIORITY != STM32_IRQ_EXTI10_15_PRIORITY
+#        error "Trackball EXTI vectors must share a priority for the single-producer edge queue"
+#    endif
+#endif
+
+static edge_event_t events[EDGE_QUEUE_SIZE];
+static volatile uint8_t head = 0; // written by the producer only
+static volatile uint8_t tail = 0; // written by the consumer only
+static volatile uint16_t overflows = 0;
+
+bool edge_queue_push(uint8_t axis, int8_t direction, uint32_t time) {
+  const uint8_t h = head;
+  if ((uint8_t)(h - tail) >= EDGE_QUEUE_SIZE) {
+    // Consumer fell behind; dropping the newest edge keeps the queue ordered.
+    overflows++;
+    return false;
+  }
+
+  edge_event_t* ev = &events[h & (EDGE_QUEUE_SIZE - 1)];
+  ev->time = time;
+  ev->axis = axis;
+  ev->direction = direction;
+
+  // Publish the slot only after its contents are written
+  __DMB();
+  head = h + 1;
+  return true;
+}
+
+bool edge_queue_pop(edge_event_t* ev) {
+  const uint8_t t = tail;
+  if (t == head) {
+    return false;
+  }
+
+  // Don't read the slot before observing the producer's head update
+  __DMB();
+  *ev = events[t & (EDGE_QUEUE_SIZE - 1)];
+  __DMB();
+  tail = t + 1;
+  return true;
+}
+
+uint16_t edge_queue_overflows(void) {
+  return overflows;
+}
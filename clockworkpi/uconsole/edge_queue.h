@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Must be a power of two. At several hundred edges per second per axis and
+// one drain per report this leaves plenty of headroom.
+#define EDGE_QUEUE_SIZE 64
+
+typedef struct {
+  uint32_t time;     // hrtimer_read() when the edge fired, in microseconds
+  uint8_t  axis;
+  int8_t   direction;
+} edge_event_t;
+
+/*
+ * Single-producer/single-consumer ring of raw trackball edges.
+ *
+ * Producer: the TB_* PAL line callbacks. They run from the EXTI9_5 and
+ * EXTI15_10 vectors, which share a priority and therefore never preempt each
+ * other, so together they behave as one producer.
+ * Consumer: pointing_device_driver_get_report() on the main loop.
+ */
+bool edge_queue_push(uint8_t axis, int8_t direction, uint32_t time);
+bool edge_queue_pop(edge_event_t* ev);
+uint16_t edge_queue_overflows(void);
@@ -0,0 +1,48 @@
+#include "edge_record.h"
+#include "trackball_motion.h"
+
+#ifdef EDGE_RECORD_ENABLE
+
+// Written and read from the main loop only (queue drain and raw HID)
+static uint32_t records[EDGE_RECORD_SIZE];
+static uint16_t next = 0;  // slot for the next entry
+static uint16_t count = 0; // entries held
+static bool recording = false;
+
+void edge_record_start(void) {
+  next = 0;
+  count = 0;
+  recording = true;
+}
+
+void edge_record_stop(void) {
+  recording = false;
+}
+
+bool edge_record_active(void) {
+  return recording;
+}
+
+void edge_record_add(const edge_event_t* ev, bool dropped) {
+  if (!recording) return;
+
+  uint32_t word = ev->time & EDGE_RECORD_TIME_MASK;
+  if (ev->axis == AXIS_Y) word |= EDGE_RECORD_AXIS_Y;
+  if (ev->direction == TB_INCR) word |= EDGE_RECORD_INCR;
+  if (dropped) word |= EDGE_RECORD_DROPPED;
+
+  records[next] = word;
+  next = (next + 1) % EDGE_RECORD_SIZE;
+  if (count < EDGE_RECORD_SIZE) count++;
+}
+
+uint16_t edge_record_count(void) {
+  return count;
+}
+
+uint32_t edge_record_get(uint16_t index) {
+  if (index >= count) return 0;
+  return records[(next + EDGE_RECORD_SIZE - count + index) % EDGE_RECORD_SIZE];
+}
+
+#endif
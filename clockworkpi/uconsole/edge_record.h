@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "edge_queue.h"
+
+/*
+ * Opt-in recorder of raw trackball edges (EDGE_RECORD_ENABLE = yes in
+ * rules.mk), read out over raw HID (HID_CMD_EDGE_*).
+ *
+ * Every edge drained from the edge queue is stored as one 32-bit word in a
+ * RAM ring that overwrites its oldest entry when full. The word layout is a
+ * stable format for offline tuning:
+ *
+ *   bits  0..28  timestamp, hrtimer microseconds modulo 2^29 (wraps every
+ *                ~9 minutes; unwrap by assuming time only moves forward)
+ *   bit  29      axis, 0 = AXIS_X, 1 = AXIS_Y
+ *   bit  30      direction, 0 = TB_DECR, 1 = TB_INCR
+ *   bit  31      1 if the anti-rebound filter dropped the edge
+ *
+ * To replay a capture, feed every word in order (dropped ones included) to
+ * trackball_move(axis, direction, unwrapped time); bit 31 is what the
+ * firmware decided at capture time, for comparing against a tuned filter.
+ */
+#ifndef EDGE_RECORD_SIZE
+#    define EDGE_RECORD_SIZE 512
+#endif
+
+#define EDGE_RECORD_TIME_MASK ((1UL << 29) - 1)
+#define EDGE_RECORD_AXIS_Y    (1UL << 29)
+#define EDGE_RECORD_INCR      (1UL << 30)
+#define EDGE_RECORD_DROPPED   (1UL << 31)
+
+#ifdef EDGE_RECORD_ENABLE
+// Clears the ring and starts recording
+void edge_record_start(void);
+void edge_record_stop(void);
+bool edge_record_active(void);
+void edge_record_add(const edge_event_t* ev, bool dropped);
+// Entries held, at most EDGE_RECORD_SIZE
+uint16_t edge_record_count(void);
+// Entry `index` counted from the oldest one held
+uint32_t edge_record_get(uint16_t index);
+#else
+static inline void edge_record_add(const edge_event_t* ev, bool dropped) {
+  (void)ev;
+  (void)dropped;
+}
+#endif
@@ -0,0 +1,73 @@
+#include "fixed_point.h"
+
+// Bitwise integer square root (floor). Only shifts, adds and compares, so it
+// stays cheap on a core without an FPU.
+static uint32_t isqrt64(uint64_t x) {
+  uint64_t res = 0;
+  uint64_t bit = (uint64_t)1 << 62;
+
+  while (bit > x) bit >>= 2;
+
+  while (bit != 0) {
+    if (x >= res + bit) {
+      x -= res + bit;
+      res = (res >> 1) + bit;
+    } else {
+      res >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (uint32_t)res;
+}
+
+uint32_t isqrt32(uint32_t x) {
+  uint32_t res = 0;
+  uint32_t bit = (uint32_t)1 << 30;
+
+  while (bit > x) bit >>= 2;
+
+  while (bit != 0) {
+    if (x >= res + bit) {
+      x -= res + bit;
+      res = (res >> 1) + bit;
+    } else {
+      res >>= 1;
+    }
+    bit >>= 2;
+  }
+  return res;
+}
+
+fix16_t fix16_sqrt(fix16_t x) {
+  if (x <= 0) return 0;
+  // sqrt(x * 2^16) == sqrt(x / 2^16) * 2^16
+  return (fix16_t)isqrt64((uint64_t)x << FIX16_SHIFT);
+}
+
+fix16_t fix16_hypot(fix16_t a, fix16_t b) {
+  // Both squares carry 2^32 scale, so the root lands back in Q16.16.
+  uint64_t sum = (uint64_t)((int64_t)a * a) + (uint64_t)((int64_t)b * b);
+  return (fix16_t)isqrt64(sum);
+}
+
+// 2^(-i/32) in Q16.16 for one octave, both ends included
+static const uint32_t exp2_neg_table[33] = {
+  65536, 64132, 62757, 61413, 60097, 58809, 57549, 56316,
+  55109, 53928, 52773, 51642, 50535, 49452, 48393, 47356,
+  46341, 45348, 44376, 43425, 42495, 41584, 40693, 39821,
+  38968, 38133, 37316, 36516, 35734, 34968, 34219, 33486,
+  32768,
+};
+
+fix16_t fix16_exp2_neg(fix16_t x) {
+  if (x <= 0) return FIX16_ONE;
+  // 2^-x = 2^-frac(x) >> int(x); the fraction is looked up in 1/32 steps and
+  // interpolated over the remaining 11 bits
+  const uint32_t octave = (uint32_t)x >> FIX16_SHIFT;
+  if (octave > FIX16_SHIFT) return 0;
+  const uint32_t index = ((uint32_t)x >> 11) & 31;
+  const uint32_t frac = (uint32_t)x & 0x7FF;
+  const uint32_t a = exp2_neg_table[index];
+  const uint32_t b = exp2_neg_table[index + 1];
+  return (fix16_t)((a - (((a - b) * frac) >> 11)) >> octave);
+}
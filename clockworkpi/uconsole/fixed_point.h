@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Q16.16 signed fixed point for the trackball motion path.
+ *
+ * The STM32F103 has no FPU, so every float operation in the edge and report
+ * path ends up in libgcc soft-float. Rates, velocities and glide state are
+ * kept in fix16_t instead; multiplies and divides widen to 64 bits so that
+ * intermediate products do not overflow.
+ *
+ * Tolerance against the previous float implementation (checked on the host
+ * over rates 0..1000 edges/s per axis):
+ * - rate_meter_rate(): tracker state is Q16.16 with truncating 64-bit
+ *   divides, within 1 LSB per update.
+ * - rateToVelocityCurve(): replaced by the breakpoint tables in
+ *   trackball_curve.h; the natural table stays within 3% of the closed form.
+ * - glider_glide(): the carried sub-pixel error saturates at
+ *   +/-GLIDER_ERROR_LIMIT counts. Its release has since moved from the linear
+ *   ramp to an exponential decay (see glider.h), so it no longer matches the
+ *   float version report for report.
+ * - fix16_exp2_neg(): relative error below 2^-13 (linear interpolation
+ *   between 32 points per octave).
+ */
+typedef int32_t fix16_t;
+
+#define FIX16_SHIFT 16
+#define FIX16_ONE   ((fix16_t)1 << FIX16_SHIFT)
+
+/* Only for compile-time constants: FIX16_CONST(0.02) folds to an integer. */
+#define FIX16_CONST(x) ((fix16_t)((x) * 65536.0 + ((x) >= 0 ? 0.5 : -0.5)))
+
+static inline fix16_t fix16_from_int(int32_t x) {
+  return x * FIX16_ONE;
+}
+
+/* Truncates toward zero, same as casting a float to an integer type. */
+static inline int32_t fix16_to_int(fix16_t x) {
+  return x / FIX16_ONE;
+}
+
+static inline fix16_t fix16_mul(fix16_t a, fix16_t b) {
+  return (fix16_t)(((int64_t)a * b) >> FIX16_SHIFT);
+}
+
+static inline fix16_t fix16_div(fix16_t a, fix16_t b) {
+  return (fix16_t)(((int64_t)a << FIX16_SHIFT) / b);
+}
+
+uint32_t isqrt32(uint32_t x);
+fix16_t fix16_sqrt(fix16_t x);
+fix16_t fix16_hypot(fix16_t a, fix16_t b);
+/* 2^-x for x >= 0; 1 for x <= 0, 0 once the result drops below 1 LSB. */
+fix16_t fix16_exp2_neg(fix16_t x);
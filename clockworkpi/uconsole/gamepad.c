@@ -0,0 +1,93 @@
+#include "quantum.h"
+#include "gamepad.h"
+#include "kb_config.h"
+
+#define GAMEPAD_AXES 2
+
+typedef struct {
+    bool     held[2];  // [0] negative, [1] positive direction key down
+    uint8_t  last;     // side pressed most recently
+    int8_t   dir;      // resolved direction
+    uint16_t since;    // timer_read() when dir last changed
+    int16_t  value;    // last value handed to joystick_set_axis()
+} gamepad_axis_t;
+
+static gamepad_axis_t gamepad_axes[GAMEPAD_AXES];
+static gamepad_socd_t gamepad_socd = GAMEPAD_SOCD_LAST;
+static bool           gamepad_ramp = false;
+
+static int8_t gamepad_resolve(const gamepad_axis_t *a) {
+    if (a->held[0] && a->held[1]) {
+        switch (gamepad_socd) {
+            case GAMEPAD_SOCD_NEUTRAL:
+                return 0;
+            case GAMEPAD_SOCD_FIRST:
+                return a->last ? -1 : 1;
+            default:
+                return a->last ? 1 : -1;
+        }
+    }
+    return a->held[1] - a->held[0];
+}
+
+static int16_t gamepad_value(const gamepad_axis_t *a) {
+    if (!a->dir || !gamepad_ramp) return a->dir * GAMEPAD_AXIS_MAX;
+
+    const uint16_t elapsed = timer_elapsed(a->since);
+    if (elapsed >= GAMEPAD_RAMP_MS) return a->dir * GAMEPAD_AXIS_MAX;
+    return a->dir * (GAMEPAD_RAMP_START + (int16_t)((uint32_t)(GAMEPAD_AXIS_MAX - GAMEPAD_RAMP_START) * elapsed / GAMEPAD_RAMP_MS));
+}
+
+// Hands a changed value to the joystick; returns true if it changed
+static bool gamepad_update(uint8_t axis) {
+    gamepad_axis_t *a     = &gamepad_axes[axis];
+    const int16_t   value = gamepad_value(a);
+    if (value == a->value) return false;
+    a->value = value;
+    joystick_set_axis(axis, value);
+    return true;
+}
+
+void gamepad_init(void) {
+    gamepad_socd = kb_config.gamepad_socd < GAMEPAD_SOCD_NUM ? kb_config.gamepad_socd : GAMEPAD_SOCD_LAST;
+    gamepad_ramp = kb_config.gamepad_ramp;
+}
+
+void gamepad_direction(uint8_t axis, int8_t direction, bool pressed) {
+    if (axis >= GAMEPAD_AXES) return;
+    gamepad_axis_t *a = &gamepad_axes[axis];
+
+    a->held[direction > 0] = pressed;
+    if (pressed) a->last = direction > 0;
+
+    const int8_t dir = gamepad_resolve(a);
+    if (dir != a->dir) {
+        a->dir   = dir;
+        a->since = timer_read();
+    }
+    // Send now rather than on the next joystick task pass
+    if (gamepad_update(axis)) joystick_flush();
+}
+
+void gamepad_task(void) {
+    if (!gamepad_ramp) return;
+    bool changed = false;
+    for (uint8_t axis = 0; axis < GAMEPAD_AXES; axis++) {
+        changed |= gamepad_update(axis);
+    }
+    if (changed) joystick_flush();
+}
+
+void gamepad_socd_cycle(void) {
+    gamepad_socd           = (gamepad_socd + 1) % GAMEPAD_SOCD_NUM;
+    kb_config.gamepad_socd = gamepad_socd;
+    kb_config_save();
+    uprintf("gamepad socd: %s\n", gamepad_socd == GAMEPAD_SOCD_LAST ? "last" : gamepad_socd == GAMEPAD_SOCD_NEUTRAL ? "neutral" : "first");
+}
+
+void gamepad_ramp_toggle(void) {
+    gamepad_ramp           = !gamepad_ramp;
+    kb_config.gamepad_ramp = gamepad_ramp;
+    kb_config_save();
+    uprintf("gamepad ramp: %s\n", gamepad_ramp ? "on" : "off");
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Digital D-pad to joystick axis engine for the gamepad layer.
+ *
+ * Each axis tracks both of its directions, so holding left+right is resolved
+ * by the SOCD (simultaneous opposite cardinal directions) policy instead of
+ * whichever key wrote last, and releasing one of the two hands the axis back
+ * to the other. Axis changes are flushed to the host from the key event
+ * itself, and only when the value moved.
+ *
+ * With the ramp on, a direction starts at GAMEPAD_RAMP_START and reaches full
+ * deflection after GAMEPAD_RAMP_MS, like pushing an analog stick; releases
+ * and reversals still act at once.
+ */
+#ifndef GAMEPAD_RAMP_MS
+#    define GAMEPAD_RAMP_MS 120
+#endif
+#ifndef GAMEPAD_RAMP_START
+#    define GAMEPAD_RAMP_START 48
+#endif
+#define GAMEPAD_AXIS_MAX 127
+
+typedef enum {
+    GAMEPAD_SOCD_LAST = 0, // the most recent press wins
+    GAMEPAD_SOCD_NEUTRAL,  // opposite directions cancel out
+    GAMEPAD_SOCD_FIRST,    // the direction held first keeps the axis
+    GAMEPAD_SOCD_NUM
+} gamepad_socd_t;
+
+/**
+ * @brief Applies the SOCD policy and ramp setting stored in kb_config.
+ */
+void gamepad_init(void);
+
+/**
+ * @brief Feeds a D-pad key. `direction` is -1 or 1 along joystick `axis`.
+ */
+void gamepad_direction(uint8_t axis, int8_t direction, bool pressed);
+
+/**
+ * @brief Advances running ramps; called from the housekeeping task.
+ */
+void gamepad_task(void);
+
+/**
+ * @brief Switches to the next SOCD policy and stores it in EEPROM.
+ */
+void gamepad_socd_cycle(void);
+
+/**
+ * @brief Turns the analog ramp on or off and stores the choice in EEPROM.
+ */
+void gamepad_ramp_toggle(void);
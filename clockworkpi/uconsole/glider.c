@@ -1,6 +1,13 @@
-#include "quantum.h"
 #include "glider.h"
-#include <math.h>
+
+static inline uint16_t min_u16(uint16_t a, uint16_t b) {
+  return a < b ? a : b;
+}
+
+// 2 / ln(2): half-lives per ms is this over the release time
+#define GLIDER_RATE_NUM FIX16_CONST(2.0 / 0.69314718056)
+// ln(2) / 2 * GLIDER_DECAY_HALVINGS: cut-off time over the release time
+#define GLIDER_CUTOFF_SCALE FIX16_CONST(0.34657359028 * GLIDER_DECAY_HALVINGS)
 
 void glider_set_direction(glider_t* gr, int8_t direction) {
   if (gr->direction != direction) {
@@ -9,21 +16,27 @@ void glider_set_direction(glider_t* gr, int8_t direction) {
   gr->direction = direction;
 }
 
-void glider_update(glider_t* gr, float speed, uint16_t sustain) {
+void glider_update(glider_t* gr, fix16_t speed, uint16_t sustain, uint16_t release) {
   gr->speed = speed;
+  gr->base = speed;
   gr->sustain = sustain;
-  
-  // Boost the release (coast) time for high-speed movements
-  // If speed is high, the cursor 'glides' longer before stopping.
-  if (speed > 2.0f) {
-      gr->release = sustain + (uint16_t)(speed * 10.0f); 
+  gr->elapsed = 0;
+  if (release > 0) {
+    const uint64_t cutoff = ((uint64_t)release * GLIDER_CUTOFF_SCALE) >> FIX16_SHIFT;
+    gr->tau = (fix16_t)((uint32_t)release << (FIX16_SHIFT - 1));
+    gr->rate = GLIDER_RATE_NUM / release;
+    gr->release = cutoff < 1 ? 1 : cutoff > UINT16_MAX ? UINT16_MAX : (uint16_t)cutoff;
   } else {
-      gr->release = sustain;
+    gr->tau = 0;
+    gr->rate = 0;
+    gr->release = 0;
   }
 }
 
-void glider_update_speed(glider_t* gr, float speed) {
+void glider_update_speed(glider_t* gr, fix16_t speed) {
   gr->speed = speed;
+  gr->base = speed;
+  gr->elapsed = 0;
 }
 
 void glider_stop(glider_t* gr) {
@@ -31,47 +44,79 @@ void glider_stop(glider_t* gr) {
   gr->sustain = 0;
   gr->release = 0;
   gr->error = 0;
+  gr->base = 0;
+  gr->tau = 0;
+  gr->rate = 0;
+  gr->elapsed = 0;
 }
 
-int8_t glider_glide(glider_t* gr, uint8_t delta) {
+// 2^-(elapsed half-lives) in Q16.16
+static fix16_t glider_decay(const glider_t* gr, uint16_t elapsed) {
+  const uint64_t halvings = (uint64_t)(uint32_t)gr->rate * elapsed;
+  return halvings > INT32_MAX ? 0 : fix16_exp2_neg((fix16_t)halvings);
+}
+
+int8_t glider_glide(glider_t* gr, uint16_t delta) {
   bool already_stopped = gr->speed == 0;
+  int64_t travel = 0;
+  uint16_t left = delta;
+
+  // Constant speed while the sustain lasts
+  if (gr->sustain > 0) {
+    const uint16_t sustained = min_u16(gr->sustain, left);
+    travel += (int64_t)gr->speed * sustained;
+    gr->sustain -= sustained;
+    left -= sustained;
+  }
+
+  // Then the decay: the distance left to coast is coast * decay(elapsed), so
+  // consecutive calls telescope to the exact integral over their total time
+  if (left > 0 && gr->release > 0) {
+    const uint16_t released = min_u16(gr->release, left);
+    const int64_t coast = ((int64_t)gr->base * gr->tau) >> FIX16_SHIFT;
+    const fix16_t before = glider_decay(gr, gr->elapsed);
+    gr->elapsed += released;
+    gr->release -= released;
+    const fix16_t after = glider_decay(gr, gr->elapsed);
+    travel += (coast * before >> FIX16_SHIFT) - (coast * after >> FIX16_SHIFT);
+    gr->speed = fix16_mul(gr->base, after);
+  }
 
-  // Accumulate velocity into error buffer (use a local float for delta)
-  float fdelta = (float)delta;
-  gr->error += gr->speed * fdelta;
+  if (gr->sustain == 0 && gr->release == 0) {
+    gr->speed = 0;
+  }
+
+  // Accumulate the travel into the error buffer, saturating so the carried
+  // backlog stays representable in Q16.16
+  int64_t error = (int64_t)gr->error + travel;
+  const int64_t limit = (int64_t)GLIDER_ERROR_LIMIT << FIX16_SHIFT;
+  if (error > limit) {
+    error = limit;
+  } else if (error < -limit) {
+    error = -limit;
+  }
+  gr->error = (fix16_t)error;
 
   int8_t distance = 0;
 
-  // Use simple cast instead of floorf/ceilf: casting to int truncates toward zero,
-  // which equals floor for positive values and ceil for negative values — matching previous logic.
-  if (gr->error >= 1.0f || gr->error <= -1.0f) {
-    if (gr->error > 127.0f) {
+  // fix16_to_int() truncates toward zero, which equals floor for positive values
+  // and ceil for negative values — matching previous logic.
+  if (gr->error >= FIX16_ONE || gr->error <= -FIX16_ONE) {
+    if (gr->error > fix16_from_int(127)) {
       distance = 127;
-    } else if (gr->error < -127.0f) {
+    } else if (gr->error < fix16_from_int(-127)) {
       distance = -127;
     } else {
-      distance = (int8_t)gr->error;
+      distance = (int8_t)fix16_to_int(gr->error);
     }
   }
 
   // Remove the integer part we are reporting, keep the remainder in gr->error
-  gr->error -= (float)distance;
-
-  // Handle sustain and release decay
-  if (gr->sustain > 0) {
-    uint16_t sustained = MIN(gr->sustain, (uint16_t)delta);
-    gr->sustain -= sustained;
-  } else if (gr->release > 0) {
-    uint16_t released = MIN(gr->release, (uint16_t)delta);
-    gr->speed = gr->speed * (float)(gr->release - released) / (float)gr->release;
-    gr->release -= released;
-  } else {
-    gr->speed = 0;
-  }
+  gr->error -= fix16_from_int(distance);
 
   if (!already_stopped && gr->speed == 0) {
     glider_stop(gr);
   }
 
   return gr->direction * distance;
-}
\ No newline at end of file
+}
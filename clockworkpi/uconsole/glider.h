@@ -1,16 +1,47 @@
 #pragma once
 
+#include <stdbool.h>
+#include "fixed_point.h"
+
+// Bound on the carried sub-pixel error (in counts). Keeps speed * delta inside
+// Q16.16; the float version could carry an unbounded backlog here.
+#define GLIDER_ERROR_LIMIT 16384
+
+// Half-lives of the release decay before the glide is cut off. At 4 the glide
+// ends at 1/16 of its starting speed, 1.39 times the release time in.
+#ifndef GLIDER_DECAY_HALVINGS
+#  define GLIDER_DECAY_HALVINGS 4
+#endif
+
+/*
+ * A glider moves at constant speed for the sustain, then releases with an
+ * exponential decay whose time constant is half the release time, so it
+ * coasts as far as a linear ramp to zero over the release would have.
+ *
+ * The release is evaluated in closed form from the time since it started:
+ * the distance still to coast at t ms is base * tau * 2^-(t / half-life), and
+ * each call emits the difference over its delta. The trajectory, and with it
+ * the counts reported by any point in time, is the same whether
+ * glider_glide() is called every 1 ms or every 8 ms.
+ */
 typedef struct {
   int8_t direction;
-  float speed;
-  uint16_t sustain;
-  uint16_t release;
-  float error;
+  fix16_t speed;     // current speed, counts/ms
+  uint16_t sustain;  // ms of constant speed left
+  uint16_t release;  // ms of decay left before the glide is cut off
+  fix16_t error;
   int8_t value;
+  fix16_t base;      // speed the decay started from, counts/ms
+  fix16_t tau;       // decay time constant, ms
+  fix16_t rate;      // half-lives per ms
+  uint16_t elapsed;  // ms since the decay started
 } glider_t;
 
 void glider_set_direction(glider_t*, int8_t);
-void glider_update(glider_t*, float velocity, uint16_t sustain);
-void glider_update_speed(glider_t*, float velocity);
+// `release` is the coast time after the sustain runs out, in ms
+void glider_update(glider_t*, fix16_t velocity, uint16_t sustain, uint16_t release);
+// Changes the speed and restarts the decay from it, keeping its time constant
+// and the time left
+void glider_update_speed(glider_t*, fix16_t velocity);
 void glider_stop(glider_t*);
-int8_t glider_glide(glider_t*, uint8_t delta);
+int8_t glider_glide(glider_t*, uint16_t delta);
@@ -0,0 +1,277 @@
+#include "quantum.h"
+#include "raw_hid.h"
+#include "hid_protocol.h"
+#include "trackball.h"
+#include "trackball_motion.h"
+#include "edge_record.h"
+#include "hrtimer.h"
+#include "profile.h"
+#include "latency.h"
+#include "power.h"
+#include "debounce_adaptive.h"
+#include <stddef.h>
+
+static curve_point_t curve_staging[CURVE_MAX_POINTS];
+
+static uint16_t telemetry_interval = 0; // ms, 0 = off
+static uint32_t telemetry_last     = 0;
+
+typedef struct {
+    uint8_t offset;
+    uint8_t size;
+    int32_t min;
+    int32_t max;
+} hid_param_info_t;
+
+#define HID_PARAM(field, lo, hi) \
+    { offsetof(trackball_tuning_t, field), sizeof(((trackball_tuning_t *)0)->field), (lo), (hi) }
+
+static const hid_param_info_t hid_params[HID_PARAM_NUM] = {
+    [HID_PARAM_LOCK_THRESHOLD]  = HID_PARAM(lock_threshold, 1, 255),
+    [HID_PARAM_CORRECT_LIMIT]   = HID_PARAM(correct_limit, 0, 16),
+    [HID_PARAM_IDLE_RESET_MS]   = HID_PARAM(idle_reset_ms, 1, 5000),
+    [HID_PARAM_WHEEL_DENOM]     = HID_PARAM(wheel_denom, 1, 1000),
+    [HID_PARAM_CORRECT_SPEED]   = HID_PARAM(correct_speed, 0, FIX16_CONST(100)),
+    [HID_PARAM_PRECISION_SCALE] = HID_PARAM(precision_scale, FIX16_CONST(0.05), FIX16_ONE),
+    [HID_PARAM_BOOST_SPEED]     = HID_PARAM(boost_speed, 0, FIX16_CONST(100)),
+    [HID_PARAM_BOOST_MS]        = HID_PARAM(boost_ms, 0, FIX16_CONST(1000)),
+};
+
+static inline void put_i32(uint8_t *p, int32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+static inline void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static inline uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline int32_t get_i32(const uint8_t *p) {
+    return (int32_t)((uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
+}
+
+static hid_status_t hid_curve_get(uint8_t *data) {
+    curve_point_t points[CURVE_MAX_POINTS];
+    uint8_t       count   = 0;
+    const uint8_t first   = data[1];
+    const uint8_t profile = trackball_curve_get(points, &count);
+
+    uint8_t n = 0;
+    if (first < count) n = MIN(count - first, HID_CURVE_POINTS_PER_PACKET);
+
+    data[2] = profile;
+    data[3] = count;
+    data[4] = first;
+    data[5] = n;
+    for (uint8_t i = 0; i < n; i++) {
+        put_i32(&data[6 + i * 8], points[first + i].x);
+        put_i32(&data[10 + i * 8], points[first + i].y);
+    }
+    return HID_STATUS_OK;
+}
+
+static hid_status_t hid_curve_stage(const uint8_t *data) {
+    const uint8_t first = data[1];
+    const uint8_t n     = data[2];
+    if (n > HID_CURVE_POINTS_PER_PACKET || first + n > CURVE_MAX_POINTS) return HID_STATUS_INVALID;
+
+    for (uint8_t i = 0; i < n; i++) {
+        curve_staging[first + i].x = get_i32(&data[3 + i * 8]);
+        curve_staging[first + i].y = get_i32(&data[7 + i * 8]);
+    }
+    return HID_STATUS_OK;
+}
+
+#ifdef EDGE_RECORD_ENABLE
+static hid_status_t hid_edge_record(uint8_t *data) {
+    if (data[1]) {
+        edge_record_start();
+    } else {
+        edge_record_stop();
+    }
+    data[2] = edge_record_active();
+    put_u16(&data[3], edge_record_count());
+    put_u16(&data[5], edge_queue_overflows());
+    return HID_STATUS_OK;
+}
+
+static hid_status_t hid_edge_read(uint8_t *data) {
+    const uint16_t first = get_u16(&data[1]);
+    const uint16_t count = edge_record_count();
+
+    uint8_t n = 0;
+    if (first < count) n = MIN(count - first, HID_EDGE_WORDS_PER_PACKET);
+
+    put_u16(&data[2], count);
+    put_u16(&data[4], first);
+    data[6] = n;
+    for (uint8_t i = 0; i < n; i++) {
+        put_i32(&data[7 + i * 4], (int32_t)edge_record_get(first + i));
+    }
+    return HID_STATUS_OK;
+}
+#endif
+
+static int32_t tuning_read(const trackball_tuning_t *t, const hid_param_info_t *p) {
+    const uint8_t *field = (const uint8_t *)t + p->offset;
+    switch (p->size) {
+        case 1:
+            return *field;
+        case 2:
+            return *(const uint16_t *)field;
+        default:
+            return *(const int32_t *)field;
+    }
+}
+
+static void tuning_write(trackball_tuning_t *t, const hid_param_info_t *p, int32_t value) {
+    uint8_t *field = (uint8_t *)t + p->offset;
+    switch (p->size) {
+        case 1:
+            *field = (uint8_t)value;
+            break;
+        case 2:
+            *(uint16_t *)field = (uint16_t)value;
+            break;
+        default:
+            *(int32_t *)field = value;
+            break;
+    }
+}
+
+static hid_status_t hid_tuning_get(uint8_t *data) {
+    if (data[1] >= HID_PARAM_NUM) return HID_STATUS_INVALID;
+    const hid_param_info_t *p = &hid_params[data[1]];
+
+    data[2] = HID_PARAM_NUM;
+    put_i32(&data[3], tuning_read(trackball_motion_get_tuning(), p));
+    put_i32(&data[7], p->min);
+    put_i32(&data[11], p->max);
+    return HID_STATUS_OK;
+}
+
+static hid_status_t hid_tuning_set(uint8_t *data) {
+    if (data[1] >= HID_PARAM_NUM) return HID_STATUS_INVALID;
+    const hid_param_info_t *p     = &hid_params[data[1]];
+    const int32_t           value = get_i32(&data[2]);
+    if (value < p->min || value > p->max) return HID_STATUS_INVALID;
+
+    trackball_tuning_t tuning = *trackball_motion_get_tuning();
+    tuning_write(&tuning, p, value);
+    if (!trackball_motion_set_tuning(&tuning)) return HID_STATUS_INVALID;
+    put_i32(&data[3], value);
+    return HID_STATUS_OK;
+}
+
+static hid_status_t hid_telemetry(uint8_t *data) {
+    const uint16_t interval = get_u16(&data[1]);
+    telemetry_interval      = interval ? MAX(interval, HID_TELEMETRY_MIN_MS) : 0;
+    telemetry_last          = timer_read32();
+    put_u16(&data[2], telemetry_interval);
+    return HID_STATUS_OK;
+}
+
+void hid_protocol_task(void) {
+    if (!telemetry_interval || timer_elapsed32(telemetry_last) < telemetry_interval) return;
+    telemetry_last = timer_read32();
+
+    trackball_telemetry_t t;
+    trackball_motion_telemetry(&t, hrtimer_read());
+
+    uint8_t data[RAW_EPSIZE] = {HID_CMD_TELEMETRY, HID_STATUS_OK};
+    put_i32(&data[2], (int32_t)telemetry_last);
+    for (uint8_t axis = 0; axis < AXIS_NUM; axis++) {
+        put_i32(&data[6 + axis * 4], t.rate[axis]);
+        put_i32(&data[14 + axis * 4], t.speed[axis]);
+        put_u16(&data[22 + axis * 2], t.sustain[axis]);
+        put_u16(&data[26 + axis * 2], t.release[axis]);
+    }
+    raw_hid_send(data, sizeof(data));
+}
+
+static hid_status_t hid_stats_get(uint8_t *data) {
+    stats_t  stats;
+    uint32_t unmatched = 0;
+    bool     found     = false;
+    if (data[1] == HID_STATS_PROFILE) {
+        found = profile_get(data[2], &stats);
+    } else if (data[1] == HID_STATS_LATENCY) {
+        found = latency_get(&stats, &unmatched);
+    } else if (data[1] == HID_STATS_WAKE) {
+        found = power_get(&stats);
+    }
+    if (!found) return HID_STATUS_INVALID;
+
+    const uint8_t page = data[3];
+    if (page == 0) {
+        put_i32(&data[4], (int32_t)stats.count);
+        put_i32(&data[8], (int32_t)stats.min);
+        put_i32(&data[12], (int32_t)stats.max);
+        put_i32(&data[16], stats.count ? (int32_t)(stats.sum / stats.count) : 0);
+        put_i32(&data[20], (int32_t)unmatched);
+        return HID_STATUS_OK;
+    }
+
+    // Wide enough that a page past the end cannot wrap back onto the buckets
+    const uint16_t first = (uint16_t)(page - 1) * HID_STATS_BUCKETS_PER_PAGE;
+    if (first >= STATS_BUCKETS) return HID_STATUS_INVALID;
+    for (uint8_t i = 0; i < HID_STATS_BUCKETS_PER_PAGE; i++) {
+        put_u16(&data[4 + i * 2], first + i < STATS_BUCKETS ? stats.hist[first + i] : 0);
+    }
+    return HID_STATUS_OK;
+}
+
+static hid_status_t hid_dispatch(uint8_t *data) {
+    switch (data[0]) {
+        case HID_CMD_CURVE_SELECT:
+            if (data[1] >= CURVE_NUM || !trackball_curve_select(data[1])) return HID_STATUS_INVALID;
+            return HID_STATUS_OK;
+        case HID_CMD_CURVE_GET:
+            return hid_curve_get(data);
+        case HID_CMD_CURVE_STAGE:
+            return hid_curve_stage(data);
+        case HID_CMD_CURVE_COMMIT:
+            return trackball_curve_store(curve_staging, data[1]) ? HID_STATUS_OK : HID_STATUS_INVALID;
+#ifdef EDGE_RECORD_ENABLE
+        case HID_CMD_EDGE_RECORD:
+            return hid_edge_record(data);
+        case HID_CMD_EDGE_READ:
+            return hid_edge_read(data);
+#endif
+        case HID_CMD_TUNING_GET:
+            return hid_tuning_get(data);
+        case HID_CMD_TUNING_SET:
+            return hid_tuning_set(data);
+        case HID_CMD_TUNING_SAVE:
+            trackball_tuning_save();
+            return HID_STATUS_OK;
+        case HID_CMD_TUNING_RESET:
+            trackball_tuning_reset();
+            return HID_STATUS_OK;
+        case HID_CMD_TELEMETRY:
+            return hid_telemetry(data);
+        case HID_CMD_STATS_GET:
+            return hid_stats_get(data);
+        case HID_CMD_STATS_RESET:
+            profile_reset();
+            latency_reset();
+            debounce_stats_reset();
+            power_reset();
+            return HID_STATUS_OK;
+        default:
+            return HID_STATUS_UNKNOWN_COMMAND;
+    }
+}
+
+void raw_hid_receive(uint8_t *data, uint8_t length) {
+    if (length < RAW_EPSIZE) return;
+    data[1] = hid_dispatch(data);
+    raw_hid_send(data, length);
+}
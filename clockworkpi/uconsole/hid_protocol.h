@@ -0,0 +1,113 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Raw HID command protocol (usage page 0xFF60, usage 0x61).
+ *
+ * Every request is one RAW_EPSIZE (32 byte) report; byte 0 is the command.
+ * The reply reuses the same buffer: byte 0 echoes the command, byte 1 is a
+ * hid_status_t and the rest is command specific. Multi-byte values are little
+ * endian; curve points are two Q16.16 int32s (x = edges/s, y = velocity).
+ *
+ * HID_CMD_CURVE_SELECT   req: [1] profile                 reply: -
+ * HID_CMD_CURVE_GET      req: [1] first point index       reply: [2] active profile, [3] point count,
+ *                                                                [4] first index, [5] n, [6..] n points
+ * HID_CMD_CURVE_STAGE    req: [1] first index, [2] n,     reply: -
+ *                             [3..] n points (n <= 3)
+ * HID_CMD_CURVE_COMMIT   req: [1] point count             reply: -
+ *
+ * A custom curve is uploaded with STAGE packets into a RAM buffer, then
+ * COMMIT validates it, writes it to EEPROM and selects CURVE_CUSTOM.
+ *
+ * HID_CMD_EDGE_RECORD    req: [1] 1 = clear and start,    reply: [2] recording, [3..4] entries held,
+ *                             0 = stop                           [5..6] edge queue overflows
+ * HID_CMD_EDGE_READ      req: [1..2] first entry          reply: [2..3] entries held, [4..5] first entry,
+ *                                                                [6] n, [7..] n record words (n <= 6)
+ *
+ * Entries are counted from the oldest one held; the record word format is in
+ * edge_record.h. Stop recording before reading so the ring does not move
+ * underneath the dump. Both commands reply HID_STATUS_UNKNOWN_COMMAND unless
+ * EDGE_RECORD_ENABLE is set.
+ *
+ * HID_CMD_TUNING_GET     req: [1] hid_param_t            reply: [2] parameter count, [3..6] value,
+ *                                                                [7..10] min, [11..14] max
+ * HID_CMD_TUNING_SET     req: [1] hid_param_t,           reply: [3..6] value
+ *                             [2..5] value
+ * HID_CMD_TUNING_SAVE    req: -                           reply: -
+ * HID_CMD_TUNING_RESET   req: -                           reply: -
+ *
+ * Tuning values are int32s, Q16.16 for the speed and scale parameters (see
+ * trackball_tuning_t). SET applies immediately but only in RAM; SAVE stores
+ * the live set in EEPROM, RESET restores the defaults (in RAM).
+ *
+ * HID_CMD_TELEMETRY      req: [1..2] interval ms,        reply: [2..3] interval
+ *                             0 = off
+ *
+ * While on, the device sends an unsolicited HID_CMD_TELEMETRY report every
+ * interval (at least HID_TELEMETRY_MIN_MS): [1] HID_STATUS_OK, [2..5] time
+ * in ms, [6..9]/[10..13] x/y rate (the curve input, edges/s / 4, see
+ * rate_meter.h), [14..17]/[18..21] x/y glider speed (counts/ms, signed),
+ * [22..23]/[24..25] x/y sustain, [26..27]/[28..29] x/y release (ms). Rates
+ * and speeds are Q16.16.
+ *
+ * HID_CMD_STATS_GET      req: [1] hid_stats_t,           reply: [4..7] count, [8..11] min,
+ *                             [2] profile point,                 [12..15] max, [16..19] average,
+ *                             [3] page                           [20..23] unmatched (latency)
+ *                                                         page n > 0: [4..23] buckets
+ *                                                                10 * (n - 1) .. +9, u16 each
+ * HID_CMD_STATS_RESET    req: -                           reply: -
+ *
+ * Reads the profile.h / latency.h / power.h histograms; a source that is not
+ * compiled in, or a page past the last bucket, replies HID_STATUS_INVALID.
+ * HID_CMD_STATS_RESET clears the same counters as Select+Fn+S: the profile,
+ * latency and wake histograms and the adaptive debounce bounce counts.
+ */
+typedef enum {
+    HID_CMD_CURVE_SELECT = 0x10,
+    HID_CMD_CURVE_GET    = 0x11,
+    HID_CMD_CURVE_STAGE  = 0x12,
+    HID_CMD_CURVE_COMMIT = 0x13,
+    HID_CMD_EDGE_RECORD  = 0x20,
+    HID_CMD_EDGE_READ    = 0x21,
+    HID_CMD_TUNING_GET   = 0x30,
+    HID_CMD_TUNING_SET   = 0x31,
+    HID_CMD_TUNING_SAVE  = 0x32,
+    HID_CMD_TUNING_RESET = 0x33,
+    HID_CMD_TELEMETRY    = 0x34,
+    HID_CMD_STATS_GET    = 0x40,
+    HID_CMD_STATS_RESET  = 0x41,
+} hid_command_t;
+
+typedef enum {
+    HID_STATUS_OK = 0,
+    HID_STATUS_UNKNOWN_COMMAND,
+    HID_STATUS_INVALID,
+} hid_status_t;
+
+// trackball_tuning_t fields, in protocol order
+typedef enum {
+    HID_PARAM_LOCK_THRESHOLD,
+    HID_PARAM_CORRECT_LIMIT,
+    HID_PARAM_IDLE_RESET_MS,
+    HID_PARAM_WHEEL_DENOM,
+    HID_PARAM_CORRECT_SPEED,
+    HID_PARAM_PRECISION_SCALE,
+    HID_PARAM_BOOST_SPEED,
+    HID_PARAM_BOOST_MS,
+    HID_PARAM_NUM
+} hid_param_t;
+
+typedef enum {
+    HID_STATS_PROFILE = 0,
+    HID_STATS_LATENCY,
+    HID_STATS_WAKE,
+} hid_stats_t;
+
+#define HID_CURVE_POINTS_PER_PACKET 3
+#define HID_EDGE_WORDS_PER_PACKET 6
+#define HID_STATS_BUCKETS_PER_PAGE 10
+#define HID_TELEMETRY_MIN_MS 10
+
+// Sends the telemetry stream; called from the housekeeping task
+void hid_protocol_task(void);
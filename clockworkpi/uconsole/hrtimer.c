@@ -0,0 +1,43 @@
+#include "quantum.h"
+#include "hrtimer.h"
+
+#if defined(STM32_ST_USE_TIMER) && (STM32_ST_USE_TIMER == 3 || STM32_ST_USE_TIMER == 4)
+#    error "hrtimer needs TIM3/TIM4, but the system tick is using one of them"
+#endif
+
+void hrtimer_init(void) {
+    RCC->APB1ENR |= (RCC_APB1ENR_TIM3EN | RCC_APB1ENR_TIM4EN);
+
+    // TIM3: 1 MHz low half, emits TRGO on every overflow
+    TIM3->CR1 = 0;
+    TIM3->PSC = (STM32_TIMCLK1 / 1000000U) - 1U;
+    TIM3->ARR = 0xFFFF;
+    TIM3->CR2 = TIM_CR2_MMS_1; // MMS = 010: update event as TRGO
+    TIM3->EGR = TIM_EGR_UG;    // load PSC before TIM4 starts listening
+    TIM3->SR = 0;
+    TIM3->CNT = 0;
+
+    // TIM4: high half, external clock mode 1 from ITR2 (= TIM3 TRGO)
+    TIM4->CR1 = 0;
+    TIM4->PSC = 0;
+    TIM4->ARR = 0xFFFF;
+    TIM4->SMCR = TIM_SMCR_TS_1 | TIM_SMCR_SMS_2 | TIM_SMCR_SMS_1 | TIM_SMCR_SMS_0;
+    TIM4->EGR = TIM_EGR_UG;
+    TIM4->SR = 0;
+    TIM4->CNT = 0;
+
+    TIM4->CR1 = TIM_CR1_CEN;
+    TIM3->CR1 = TIM_CR1_CEN;
+}
+
+uint32_t hrtimer_read(void) {
+    uint16_t lo1, hi, lo2;
+    do {
+        lo1 = TIM3->CNT;
+        hi  = TIM4->CNT;
+        lo2 = TIM3->CNT;
+        // Retry if the low half wrapped between the reads, or just wrapped and
+        // the carry into TIM4 may still be in the trigger synchroniser.
+    } while (lo2 < lo1 || lo1 == 0);
+    return ((uint32_t)hi << 16) | lo2;
+}
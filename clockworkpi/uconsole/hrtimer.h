@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Free-running 32-bit microsecond counter.
+ *
+ * TIM3 is prescaled to 1 MHz and its update event clocks TIM4, which
+ * holds the upper 16 bits. Wraps after ~71 minutes; use unsigned
+ * differences like TIMER_DIFF_32().
+ */
+void hrtimer_init(void);
+uint32_t hrtimer_read(void);
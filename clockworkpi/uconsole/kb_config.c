@@ -0,0 +1,31 @@
+#include "quantum.h"
+#include "kb_config.h"
+
+_Static_assert(sizeof(trackball_tuning_t) == 24, "trackball_tuning_t is stored as is and must not change size");
+_Static_assert(sizeof(kb_datablock_t) == EECONFIG_KB_DATA_SIZE, "EECONFIG_KB_DATA_SIZE must match kb_datablock_t");
+
+kb_config_t kb_config;
+
+// Runs from keyboard_pre_init_kb(), before QMK checks the EEPROM and resets
+// it if invalid; an erased or stale EEPROM reads as defaults, not as 0xFF..
+void kb_config_load(void) {
+    kb_config.raw = eeconfig_is_enabled() ? eeconfig_read_kb() : 0;
+}
+
+void kb_config_save(void) {
+    eeconfig_update_kb(kb_config.raw);
+}
+
+void kb_datablock_load(kb_datablock_t *data) {
+    eeconfig_read_kb_datablock(data, 0, sizeof(*data));
+}
+
+void kb_datablock_save(const kb_datablock_t *data) {
+    eeconfig_update_kb_datablock(data, 0, sizeof(*data));
+}
+
+void eeconfig_init_kb(void) {
+    kb_config.raw = 0;
+    kb_config_save();
+    eeconfig_init_user();
+}
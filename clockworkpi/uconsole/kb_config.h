@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "trackball_curve.h"
+#include "trackball_motion.h"
+
+/*
+ * Keyboard-level settings kept in the EEPROM kb word (eeconfig_*_kb). The
+ * keymap keeps its own settings in the user word. Fields read as 0 on a
+ * device that never stored them, so 0 must always mean "default".
+ */
+typedef union {
+    uint32_t raw;
+    struct {
+        uint16_t cpi;   // trackball CPI, 0 = TRACKBALL_DEFAULT_CPI
+        uint8_t  curve; // curve_profile_t, 0 = CURVE_NATURAL
+        bool     coarse_scroll : 1; // 1 = classic detents for hosts without hi-res wheel support
+        uint8_t  gamepad_socd : 2;  // gamepad_socd_t, 0 = GAMEPAD_SOCD_LAST
+        bool     gamepad_ramp : 1;  // 1 = analog ramp on D-pad directions
+    };
+} kb_config_t;
+
+/*
+ * Larger settings in the EEPROM kb datablock (EECONFIG_KB_DATA_SIZE bytes).
+ * QMK zeroes the block when it is not valid (or its size changed), so a zero
+ * count means "no table" and a zero tuning_stored means "default tuning".
+ * Writers must load the block first and only change their own fields.
+ */
+typedef struct {
+    uint8_t            curve_count;
+    uint8_t            tuning_stored;
+    uint8_t            reserved[2];
+    curve_point_t      curve[CURVE_MAX_POINTS];
+    trackball_tuning_t tuning;
+} kb_datablock_t;
+
+extern kb_config_t kb_config;
+
+void kb_config_load(void);
+void kb_config_save(void);
+void kb_datablock_load(kb_datablock_t *data);
+void kb_datablock_save(const kb_datablock_t *data);
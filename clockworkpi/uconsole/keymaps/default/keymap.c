@@ -2,6 +2,14 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include QMK_KEYBOARD_H
+#include <string.h>
+#include "profile.h"
+#include "latency.h"
+#include "debounce_adaptive.h"
+#include "trackball.h"
+#include "gamepad.h"
+#include "power.h"
+#include "matrix_settle.h"
 
 enum {
   LY0 = 0,
@@ -66,7 +74,12 @@ enum {
   JS_UP,
   JS_DOWN,
   KB_LOCK,
-  KB_TAP_HOLD      // Toggle tap-hold feature
+  KB_TAP_HOLD,     // Toggle tap-hold feature
+  KB_CPI,          // Next trackball CPI step (Select+key: previous)
+  KB_CURVE,        // Next trackball acceleration curve
+  KB_SCRL,         // Toggle hi-res / detent wheel scrolling
+  KB_PAD,          // Next gamepad SOCD policy (Select+key: toggle analog ramp)
+  KB_STAT          // Print profiling/latency/debounce/wake stats on the console (Select+key resets them)
 };
 
 const key_override_t vol_key_override =
@@ -121,7 +134,10 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
      * (   )(   )(   )(   )(THd)(Tg2)(Hom)(End)(PgD)(   )(   )(   )
      * (Hom)(PgD)(   )(   )(   )(Clr)(   )(   )
      * (   )(   )(Cmd)(      BlStp       )(Cmd)(   )(  )
-     * THd = Tap-Hold Toggle, Clr = EEPROM Clear
+     * THd = Tap-Hold Toggle, Clr = EEPROM Clear, Fn+S = Console stats (Select+Fn+S resets),
+     * Fn+M = Next trackball CPI (Select+Fn+M: previous), Fn+N = Next trackball curve,
+     * Fn+W = Hi-res / detent scrolling, Fn+F = Gamepad SOCD policy (Select+Fn+F: analog ramp),
+     * BlStp = Backlight level (Select+BlStp: breathing)
      */
 
     [LY1] = LAYOUT(
@@ -132,10 +148,10 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
         KC_PSCR, KC_PAUS, KC_MUTE, _______, _______, _______, KC_F11,  KC_F12,
         KC_F1,   KC_F2,   KC_F3,   KC_F4,   KC_F5,   KC_F6,   KC_F7,   KC_F8,
         KC_F9,   KC_F10,  KB_LOCK, KC_CAPS, _______, _______, _______, _______,
-        _______, _______, _______, _______, KB_TAP_HOLD, _______, KC_PGUP, KC_INS,
-        _______, _______, _______, _______, _______, _______, TG(LY2), KC_HOME,
+        _______, KB_SCRL, _______, _______, KB_TAP_HOLD, _______, KC_PGUP, KC_INS,
+        _______, _______, _______, KB_STAT, _______, KB_PAD,  TG(LY2), KC_HOME,
         KC_END,  KC_PGDN, _______, _______, _______, EE_CLR,  _______, _______,
-        _______, _______, KC_BRID, KC_BRIU, _______, _______, _______, _______,
+        KB_CURVE, KB_CPI, KC_BRID, KC_BRIU, _______, _______, _______, _______,
         KC_DEL,  _______, _______, _______, BL_STEP, _______, _______, _______
     ),
 
@@ -183,51 +199,95 @@ keyboard_config_t keyboard_config;
 // Tap-hold timing tracking
 #define TAP_HOLD_TIMEOUT 200  // milliseconds
 
-// Mapping of tap-hold keycodes to their base keycodes
-static const uint16_t tap_hold_map[][2] = {
-  {LH_A, KC_A},  {LH_B, KC_B},  {LH_C, KC_C},  {LH_D, KC_D},  {LH_E, KC_E},
-  {LH_F, KC_F},  {LH_G, KC_G},  {LH_H, KC_H},  {LH_I, KC_I},  {LH_J, KC_J},
-  {LH_K, KC_K},  {LH_L, KC_L},  {LH_M, KC_M},  {LH_N, KC_N},  {LH_O, KC_O},
-  {LH_P, KC_P},  {LH_Q, KC_Q},  {LH_R, KC_R},  {LH_S, KC_S},  {LH_T, KC_T},
-  {LH_U, KC_U},  {LH_V, KC_V},  {LH_W, KC_W},  {LH_X, KC_X},  {LH_Y, KC_Y},
-  {LH_Z, KC_Z},
-  {LH_0, KC_0},  {LH_1, KC_1},  {LH_2, KC_2},  {LH_3, KC_3},  {LH_4, KC_4},
-  {LH_5, KC_5},  {LH_6, KC_6},  {LH_7, KC_7},  {LH_8, KC_8},  {LH_9, KC_9},
-  {LH_GRV, KC_GRV},   {LH_LBRC, KC_LBRC}, {LH_RBRC, KC_RBRC},
-  {LH_MINS, KC_MINS},  {LH_EQL, KC_EQL},   {LH_SLSH, KC_SLSH},
-  {LH_BSLS, KC_BSLS},  {LH_SCLN, KC_SCLN}, {LH_QUOT, KC_QUOT},
-  {LH_COMM, KC_COMM},  {LH_DOT, KC_DOT},
+// Base keycode of each tap-hold key, indexed by keycode - LH_A
+#define TAP_HOLD_COUNT (LH_DOT - LH_A + 1)
+static const uint16_t tap_hold_base[TAP_HOLD_COUNT] = {
+  KC_A,    KC_B,    KC_C,    KC_D,    KC_E,    KC_F,    KC_G,    KC_H,    KC_I,
+  KC_J,    KC_K,    KC_L,    KC_M,    KC_N,    KC_O,    KC_P,    KC_Q,    KC_R,
+  KC_S,    KC_T,    KC_U,    KC_V,    KC_W,    KC_X,    KC_Y,    KC_Z,
+  KC_0,    KC_1,    KC_2,    KC_3,    KC_4,    KC_5,    KC_6,    KC_7,    KC_8,
+  KC_9,
+  KC_GRV,  KC_LBRC, KC_RBRC, KC_MINS, KC_EQL,  KC_SLSH, KC_BSLS, KC_SCLN, KC_QUOT,
+  KC_COMM, KC_DOT,
 };
+_Static_assert(TAP_HOLD_COUNT == 47, "tap_hold_base must cover LH_A..LH_DOT");
 
-static uint16_t tap_hold_key_press_times[47] = {0};  // Track press time for each tap-hold key (36 letters/numbers + 11 special chars)
+static bool is_tap_hold_key(uint16_t keycode) {
+  return keycode >= LH_A && keycode <= LH_DOT;
+}
 
-// Helper function to get base keycode from tap-hold keycode
-static uint16_t get_base_keycode(uint16_t keycode) {
-  for (int i = 0; i < 47; i++) {
-    if (tap_hold_map[i][0] == keycode) {
-      return tap_hold_map[i][1];
-    }
+// Tap-hold engine. Presses are queued in press order and resolved as a tap
+// (released before TAP_HOLD_TIMEOUT) or a hold (still down at the timeout,
+// emitted right then from housekeeping_task_user). Output leaves the queue
+// strictly in press order: a quick tap behind a key that is still undecided
+// waits for it, at most TAP_HOLD_TIMEOUT.
+#define TAP_HOLD_QUEUE_SIZE 8
+
+typedef struct {
+  uint8_t  index;    // keycode - LH_A
+  bool     released; // resolved as a tap, waiting for the keys ahead of it
+  uint16_t time;     // press time
+} tap_hold_entry_t;
+
+static tap_hold_entry_t tap_hold_queue[TAP_HOLD_QUEUE_SIZE];
+static uint8_t tap_hold_len = 0;
+
+static void tap_hold_emit(uint8_t index, bool hold) {
+  uint16_t base_key = tap_hold_base[index];
+  if (hold) {
+    // Hold - send shift + key (uppercase/shifted symbol)
+    register_code(KC_LSFT);
+    register_code(base_key);
+    unregister_code(base_key);
+    unregister_code(KC_LSFT);
+  } else {
+    // Tap - send key as-is (lowercase/number)
+    register_code(base_key);
+    unregister_code(base_key);
   }
-  return KC_NO;
 }
 
-// Helper function to check if keycode is a tap-hold key
-static bool is_tap_hold_key(uint16_t keycode) {
-  return (keycode >= LH_A && keycode <= LH_9) || (keycode >= LH_GRV && keycode <= LH_DOT);
+static void tap_hold_pop(bool hold) {
+  tap_hold_emit(tap_hold_queue[0].index, hold);
+  tap_hold_len--;
+  memmove(&tap_hold_queue[0], &tap_hold_queue[1], tap_hold_len * sizeof(tap_hold_entry_t));
 }
 
-// Helper function to get the index of a tap-hold key
-static int get_tap_hold_index(uint16_t keycode) {
-  if (keycode >= LH_A && keycode <= LH_Z) {
-    return keycode - LH_A;
+// Emits every entry at the head of the queue that is decided. With `force`,
+// keys still down are sent as taps, e.g. because another key was pressed.
+static void tap_hold_flush(bool force) {
+  while (tap_hold_len > 0) {
+    const tap_hold_entry_t *head = &tap_hold_queue[0];
+    if (head->released || force) {
+      tap_hold_pop(false);
+    } else if (timer_elapsed(head->time) >= TAP_HOLD_TIMEOUT) {
+      tap_hold_pop(true);
+    } else {
+      break;
+    }
   }
-  if (keycode >= LH_0 && keycode <= LH_9) {
-    return 26 + (keycode - LH_0);
+}
+
+static void tap_hold_press(uint8_t index, uint16_t time) {
+  if (tap_hold_len == TAP_HOLD_QUEUE_SIZE) {
+    tap_hold_pop(false);
   }
-  if (keycode >= LH_GRV && keycode <= LH_DOT) {
-    return 36 + (keycode - LH_GRV);
+  tap_hold_queue[tap_hold_len++] = (tap_hold_entry_t){.index = index, .released = false, .time = time};
+}
+
+static void tap_hold_release(uint8_t index) {
+  // A key that already went out as a hold (or forced tap) is no longer queued
+  for (uint8_t i = 0; i < tap_hold_len; i++) {
+    if (tap_hold_queue[i].index == index && !tap_hold_queue[i].released) {
+      tap_hold_queue[i].released = true;
+      break;
+    }
   }
-  return -1;
+  tap_hold_flush(false);
+}
+
+void housekeeping_task_user(void) {
+  tap_hold_flush(false);
 }
 
 void keyboard_post_init_user(void) {
@@ -248,42 +308,32 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
 
   // Handle tap-hold keys
   if (is_tap_hold_key(keycode)) {
-    uint16_t base_key = get_base_keycode(keycode);
+    uint8_t index = keycode - LH_A;
 
     // If tap-hold is disabled, send key normally
     if (!keyboard_config.tap_hold_enabled) {
       if (record->event.pressed) {
-        register_code(base_key);
+        register_code(tap_hold_base[index]);
       } else {
-        unregister_code(base_key);
+        unregister_code(tap_hold_base[index]);
       }
       return false;
     }
 
-    // Tap-hold is enabled: use timing-based logic
-    int index = get_tap_hold_index(keycode);
     if (record->event.pressed) {
-      // Key pressed - record the timestamp
-      tap_hold_key_press_times[index] = record->event.time;
+      tap_hold_press(index, record->event.time);
     } else {
-      // Key released - determine if tap or hold
-      uint16_t elapsed = record->event.time - tap_hold_key_press_times[index];
-
-      if (elapsed < TAP_HOLD_TIMEOUT) {
-        // Tap - send key as-is (lowercase/number)
-        register_code(base_key);
-        unregister_code(base_key);
-      } else {
-        // Hold - send shift + key (uppercase/shifted symbol)
-        register_code(KC_LSFT);
-        register_code(base_key);
-        unregister_code(base_key);
-        unregister_code(KC_LSFT);
-      }
+      tap_hold_release(index);
     }
     return false;  // Don't let QMK handle this key
   }
 
+  // A typed key pressed during the hold window goes out after the undecided tap-hold keys, as taps. Modifiers,
+  // Fn/layer and the custom keycodes leave them undecided, so holding Shift or Fn over a tap-hold key still works
+  if (record->event.pressed && tap_hold_len > 0 && IS_BASIC_KEYCODE(keycode)) {
+    tap_hold_flush(true);
+  }
+
   switch (keycode) {
     case KB_LOCK:
       if (record->event.pressed) {
@@ -296,6 +346,43 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
         eeconfig_update_user(keyboard_config.raw);
       }
       return false;
+    case KB_CPI:
+      if (record->event.pressed) {
+        trackball_cpi_step(select_button_pressed ? -1 : 1);
+      }
+      return false;
+    case KB_CURVE:
+      if (record->event.pressed) {
+        trackball_curve_cycle();
+      }
+      return false;
+    case KB_SCRL:
+      if (record->event.pressed) {
+        trackball_scroll_toggle();
+      }
+      return false;
+    case KB_STAT:
+      if (record->event.pressed) {
+        if (select_button_pressed) {
+          profile_reset();
+          latency_reset();
+          debounce_stats_reset();
+          power_reset();
+        } else {
+          profile_print();
+          matrix_settle_print();
+          latency_print();
+          debounce_stats_print();
+          power_print();
+        }
+      }
+      return false;
+    case BL_STEP:
+      if (select_button_pressed) {
+        if (record->event.pressed) breathing_toggle();
+        return false;
+      }
+      return true;
     case MO(LY1):
       // Fn: only perform normal layer switching; do not toggle scroll mode
       return true;  // Allow normal layer switching to continue
@@ -303,17 +390,26 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
       // Select key enables scroll mode while held (preserve tap behavior)
       select_button_pressed = record->event.pressed;
       return true;
+    case KB_PAD:
+      if (record->event.pressed) {
+        if (select_button_pressed) {
+          gamepad_ramp_toggle();
+        } else {
+          gamepad_socd_cycle();
+        }
+      }
+      return false;
     case JS_LEFT:
-      joystick_set_axis(1, record->event.pressed ? -127 : 0);
+      gamepad_direction(1, -1, record->event.pressed);
       return false;
     case JS_RGHT:
-      joystick_set_axis(1, record->event.pressed ? 127 : 0);
+      gamepad_direction(1, 1, record->event.pressed);
       return false;
     case JS_UP:
-      joystick_set_axis(0, record->event.pressed ? -127 : 0);
+      gamepad_direction(0, -1, record->event.pressed);
       return false;
     case JS_DOWN:
-      joystick_set_axis(0, record->event.pressed ? 127 : 0);
+      gamepad_direction(0, 1, record->event.pressed);
       return false;
     case MS_BTN3:
       if (record->event.pressed && select_button_pressed) {
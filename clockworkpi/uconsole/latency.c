@@ -0,0 +1,86 @@
+#include "quantum.h"
+#include "hrtimer.h"
+#include "latency.h"
+#include "stats.h"
+
+#ifdef LATENCY_ENABLE
+
+static stats_t latency_stats;
+static uint32_t latency_unmatched = 0;
+
+static bool latency_pending = false;
+static uint32_t latency_start = 0;
+
+// Copy of the protocol's driver with the report senders redirected here
+static host_driver_t *latency_host = NULL;
+static host_driver_t latency_driver;
+
+static void latency_report_sent(void) {
+    if (!latency_pending) return;
+    const uint32_t elapsed = hrtimer_read() - latency_start;
+    latency_pending = false;
+    if (elapsed >= (uint32_t)LATENCY_TIMEOUT_MS * 1000) {
+        latency_unmatched++;
+    } else {
+        stats_add(&latency_stats, elapsed);
+    }
+}
+
+static void latency_send_keyboard(report_keyboard_t *report) {
+    latency_host->send_keyboard(report);
+    latency_report_sent();
+}
+
+static void latency_send_nkro(report_nkro_t *report) {
+    latency_host->send_nkro(report);
+    latency_report_sent();
+}
+
+static void latency_send_extra(report_extra_t *report) {
+    latency_host->send_extra(report);
+    latency_report_sent();
+}
+
+void latency_matrix_changed(void) {
+    if (latency_pending) return;
+    latency_pending = true;
+    latency_start = hrtimer_read();
+}
+
+// The protocol only installs its driver after keyboard_post_init, so wrap it
+// from the housekeeping task once it shows up.
+void latency_task(void) {
+    host_driver_t *driver = host_get_driver();
+    if (driver != NULL && driver != &latency_driver) {
+        latency_host                 = driver;
+        latency_driver               = *driver;
+        latency_driver.send_keyboard = latency_send_keyboard;
+        latency_driver.send_nkro     = latency_send_nkro;
+        latency_driver.send_extra    = latency_send_extra;
+        host_set_driver(&latency_driver);
+    }
+
+    if (latency_pending && hrtimer_read() - latency_start >= (uint32_t)LATENCY_TIMEOUT_MS * 1000) {
+        latency_pending = false;
+        latency_unmatched++;
+    }
+}
+
+void latency_reset(void) {
+    stats_reset(&latency_stats);
+    latency_unmatched = 0;
+    latency_pending   = false;
+}
+
+bool latency_get(stats_t *out, uint32_t *unmatched) {
+    *out       = latency_stats;
+    *unmatched = latency_unmatched;
+    return true;
+}
+
+void latency_print(void) {
+    stats_print("key_latency", "us", &latency_stats);
+    uprintf("key_latency unmatched: %lu\n", (unsigned long)latency_unmatched);
+}
+
+#endif
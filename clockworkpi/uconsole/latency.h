@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "stats.h"
+
+/*
+ * Opt-in keypress-to-report latency histogram (LATENCY_ENABLE = yes in
+ * rules.mk).
+ *
+ * matrix_scan_custom() stamps the first raw matrix change that has not been
+ * reported yet; the next keyboard, NKRO or extra report handed to the USB
+ * host driver closes the sample. The figure therefore includes debounce and
+ * any tap-hold delay applied in the keymap. Mouse and joystick reports are not
+ * matched, since the trackball sends them on its own. Changes that produce no
+ * report within LATENCY_TIMEOUT_MS (layer keys, Select, held tap-hold keys)
+ * are dropped and counted as unmatched.
+ */
+#ifndef LATENCY_TIMEOUT_MS
+#    define LATENCY_TIMEOUT_MS 1000
+#endif
+
+#ifdef LATENCY_ENABLE
+void latency_matrix_changed(void);
+void latency_task(void);
+void latency_reset(void);
+void latency_print(void);
+bool latency_get(stats_t *out, uint32_t *unmatched);
+#else
+static inline void latency_matrix_changed(void) {}
+static inline void latency_task(void) {}
+static inline void latency_reset(void) {}
+static inline void latency_print(void) {}
+static inline bool latency_get(stats_t *out, uint32_t *unmatched) {
+    return false;
+}
+#endif
@@ -11,10 +11,29 @@
  * - MATRIX_ROW_PINS and MATRIX_COL_PINS are defined for the diode matrix.
  * - Direct pins are active-low (input pull-up). If yours are active-high, invert gpio_read_pin().
  * - Non-split keyboard (safe for split too if you adapt rows-per-hand mapping).
+ *
+ * Pin groups that sit on one GPIO port at consecutive pads (B0-B15 for the direct
+ * block, C0-C7 for the columns) are read with one IDR access per group instead of
+ * one gpio_read_pin() per pin. Any other pin map, or MATRIX_NO_BULK_READ, falls
+ * back to per-pin reads.
+ *
+ * COL2ROW rows are open-drain outputs that idle high (Hi-Z). Releasing row N and
+ * selecting row N+1 happen back to back, followed by a single settle wait of
+ * `matrix_settle_us`. Define MATRIX_SETTLE_US in config.h to fix that wait;
+ * otherwise it is calibrated at init from the column pull-up recovery time.
+ *
+ * When nothing is pressed the diode matrix drops into an interrupt-armed idle
+ * mode, see MATRIX_IDLE_TIMEOUT below.
  */
 
 #include "quantum.h"
 #include "gpio.h"
+#include "hrtimer.h"
+#include "profile.h"
+#include "latency.h"
+#include "sof_sync.h"
+#include "matrix_settle.h"
+#include "matrix_idle.h"
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
@@ -38,7 +57,6 @@ static const pin_t matrix_row_pins[] = MATRIX_ROW_PINS;
 static const pin_t matrix_col_pins[] = MATRIX_COL_PINS;
 #endif
 
-/* Small settling delay (tune if needed for reliable reads). */
 /* Small settling delay (tune if needed for reliable reads).
  * Use `wait_us` where available rather than a busy nop loop.
  */
@@ -46,9 +64,207 @@ static inline void small_delay(void) {
     wait_us(30);
 }
 
+/* Bounds for the calibrated settle time. The cap is the 30 us per-row wait the
+ * stock firmware shipped with. The floor keeps 10 us even when the bare column
+ * recovers at once: the internal pull-up (30-50 kOhm) against ~100 pF of
+ * column, key and diode needs ~5 us to reach V_IH, so 10 us is twice that
+ * estimate. See the README's performance notes for the ghosting check. */
+#ifndef MATRIX_SETTLE_MIN_US
+#    define MATRIX_SETTLE_MIN_US 10
+#endif
+#ifndef MATRIX_SETTLE_MAX_US
+#    define MATRIX_SETTLE_MAX_US 30
+#endif
+/* Safety margin on the measurement: the calibration only sees the bare column,
+ * and a pressed key also hangs the row line and diode on it. */
+#ifndef MATRIX_SETTLE_FACTOR
+#    define MATRIX_SETTLE_FACTOR 4
+#endif
+
+#ifdef MATRIX_SETTLE_US
+static uint8_t matrix_settle_us = MATRIX_SETTLE_US;
+#else
+static uint8_t matrix_settle_us = MATRIX_SETTLE_MAX_US;
+#endif
+/* Headroom-scaled recovery time measured at init, before clamping; 0 = not calibrated */
+static uint8_t matrix_settle_measured = 0;
+
 /* Keep previous matrix to report changes (matrix_scan_custom must return true if changed). */
 static matrix_row_t last_matrix[MATRIX_ROWS];
 
+#if !defined(MATRIX_SETTLE_US) && defined(MATRIX_COL_PINS) && defined(DIODE_DIRECTION) && (DIODE_DIRECTION == COL2ROW)
+/* Time how long each column takes to be pulled back high after being driven low,
+ * which is what a released row leaves behind. Must run after the columns are
+ * configured as pull-up inputs. */
+static void matrix_calibrate_settle(void) {
+    uint32_t worst = 0;
+    for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+        pin_t p = matrix_col_pins[c];
+        if (p == NO_PIN) continue;
+        gpio_set_pin_output(p);
+        gpio_write_pin_low(p);
+        wait_us(1);
+        gpio_set_pin_input_high(p);
+
+        const uint32_t start   = hrtimer_read();
+        uint32_t       elapsed = 0;
+        while (!gpio_read_pin(p) && elapsed < MATRIX_SETTLE_MAX_US) {
+            elapsed = hrtimer_read() - start;
+        }
+        /* Round up: a sub-microsecond recovery still reads as 0 here */
+        worst = MAX(worst, elapsed + 1);
+    }
+    worst *= MATRIX_SETTLE_FACTOR;
+    matrix_settle_measured = MIN(worst, UINT8_MAX);
+    matrix_settle_us       = MIN(MAX(worst, MATRIX_SETTLE_MIN_US), MATRIX_SETTLE_MAX_US);
+}
+#endif
+
+uint8_t matrix_settle_time(void) {
+    return matrix_settle_us;
+}
+
+void matrix_settle_print(void) {
+    uprintf("matrix settle: %u us (calibrated %u us, bounds %u-%u us)\n", matrix_settle_us, matrix_settle_measured, MATRIX_SETTLE_MIN_US, MATRIX_SETTLE_MAX_US);
+}
+
+/* Define MATRIX_NO_BULK_READ to force the per-pin reads, e.g. to compare scan times */
+#if defined(PAL_PORT) && defined(PAL_PAD) && !defined(MATRIX_NO_BULK_READ)
+#    define MATRIX_BULK_READ
+#endif
+
+#ifdef MATRIX_BULK_READ
+/* A set of up to MATRIX_COLS pins that can be sampled with a single port read:
+ * every used pin is on `port` at pad (shift + column). */
+typedef struct {
+    bool         ok;
+    ioportid_t   port;
+    uint8_t      shift;
+    matrix_row_t mask;
+} bulk_group_t;
+
+static void bulk_group_setup(bulk_group_t *g, const pin_t *pins) {
+    g->ok    = true;
+    g->port  = NULL;
+    g->shift = 0;
+    g->mask  = 0;
+    for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+        pin_t p = pins[c];
+        if (p == NO_PIN) continue;
+        ioportid_t port = PAL_PORT(p);
+        uint8_t    pad  = PAL_PAD(p);
+        if (pad < c || (g->mask != 0 && (port != g->port || pad - c != g->shift))) {
+            g->ok = false;
+            return;
+        }
+        g->port  = port;
+        g->shift = pad - c;
+        g->mask |= ((matrix_row_t)1 << c);
+    }
+}
+
+/* Pins are active-low: invert, align to column 0 and keep only the mapped columns. */
+static inline matrix_row_t bulk_group_extract(const bulk_group_t *g, ioportmask_t idr) {
+    return (matrix_row_t)(~idr >> g->shift) & g->mask;
+}
+
+#    ifdef DIRECT_PINS
+static bulk_group_t direct_groups[ROWS_PER_HAND_LOCAL];
+#    endif
+#    ifdef MATRIX_COL_PINS
+static bulk_group_t col_group;
+#    endif
+#endif
+
+#if defined(MATRIX_COL_PINS) && defined(DIODE_DIRECTION) && (DIODE_DIRECTION == COL2ROW)
+/* Pressed columns for the currently selected row(s) */
+static inline matrix_row_t matrix_read_cols(void) {
+#    ifdef MATRIX_BULK_READ
+    if (col_group.ok && col_group.mask != 0) {
+        return bulk_group_extract(&col_group, palReadPort(col_group.port));
+    }
+#    endif
+    matrix_row_t cols = 0;
+    for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+        pin_t cp = matrix_col_pins[c];
+        if (cp == NO_PIN) continue;
+        if (!gpio_read_pin(cp)) {
+            cols |= ((matrix_row_t)1 << c);
+        }
+    }
+    return cols;
+}
+#endif
+
+/* Idle mode (COL2ROW only).
+ * After MATRIX_IDLE_TIMEOUT ms with nothing pressed, all rows are driven low
+ * together and falling-edge events are armed on the column lines. Scans then
+ * only sample the direct pins and the column port until a column edge fires
+ * or a column reads low. The full scan then runs in that same call, so wake
+ * does not wait for another polling pass.
+ * The direct pins are not armed for edge events: B0-B7 and B8-B11 share EXTI
+ * lines with the columns (C0-C7) and the trackball (C8-C11). They are polled
+ * with one bulk read per pass instead.
+ * Define MATRIX_IDLE_TIMEOUT as 0 to disable.
+ */
+#ifndef MATRIX_IDLE_TIMEOUT
+#    define MATRIX_IDLE_TIMEOUT 50
+#endif
+
+#if MATRIX_IDLE_TIMEOUT > 0 && defined(PAL_USE_CALLBACKS) && PAL_USE_CALLBACKS && defined(MATRIX_ROW_PINS) && defined(MATRIX_COL_PINS) && defined(DIODE_DIRECTION) && (DIODE_DIRECTION == COL2ROW)
+#    define MATRIX_IDLE_SCAN
+
+static bool          matrix_idle = false;
+static volatile bool matrix_wake_pending = false;
+static uint16_t      matrix_active_time = 0;
+
+static void matrix_wake_cb(void *arg) {
+    (void)arg;
+    matrix_wake_pending = true;
+}
+
+static void matrix_idle_enter(void) {
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        pin_t p = matrix_row_pins[r];
+        if (p == NO_PIN) continue;
+        gpio_write_pin_low(p);
+    }
+    matrix_wake_pending = false;
+    for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+        pin_t p = matrix_col_pins[c];
+        if (p == NO_PIN) continue;
+        palEnableLineEvent(p, PAL_EVENT_MODE_FALLING_EDGE);
+        palSetLineCallback(p, matrix_wake_cb, NULL);
+    }
+    matrix_idle = true;
+}
+
+static void matrix_idle_exit(void) {
+    for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+        pin_t p = matrix_col_pins[c];
+        if (p == NO_PIN) continue;
+        palDisableLineEvent(p);
+    }
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        pin_t p = matrix_row_pins[r];
+        if (p == NO_PIN) continue;
+        gpio_write_pin_high(p);
+    }
+    matrix_wake_pending = false;
+    matrix_idle = false;
+    matrix_active_time = timer_read();
+}
+#endif
+
+bool matrix_idle_armed(void) {
+#ifdef MATRIX_IDLE_SCAN
+    /* A pending edge means a key went down that no scan has picked up yet */
+    return matrix_idle && !matrix_wake_pending;
+#else
+    return false;
+#endif
+}
+
 void matrix_init_custom(void) {
     /* Initialize direct pins (input with pull-up) */
 #ifdef DIRECT_PINS
@@ -64,7 +280,7 @@ void matrix_init_custom(void) {
     /* Initialize diode-driven matrix pins depending on diode direction */
 #if defined(DIODE_DIRECTION)
 #    if (DIODE_DIRECTION == COL2ROW)
-    /* COL2ROW: columns are inputs (pull-up), rows are outputs (idle INPUT/Hi-Z) */
+    /* COL2ROW: columns are inputs (pull-up), rows are open-drain outputs (idle high/Hi-Z) */
 #        ifdef MATRIX_COL_PINS
     for (uint8_t c = 0; c < MATRIX_COLS; c++) {
         pin_t p = matrix_col_pins[c];
@@ -76,10 +292,14 @@ void matrix_init_custom(void) {
     for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
         pin_t p = matrix_row_pins[r];
         if (p == NO_PIN) continue;
-        /* Set rows to INPUT (Hi-Z) initially to prevent ghosting/masking */
-        gpio_set_pin_input(p);
+        /* Released rows float (open-drain high) to prevent ghosting/masking */
+        gpio_set_pin_output_open_drain(p);
+        gpio_write_pin_high(p);
     }
 #        endif
+#        if !defined(MATRIX_SETTLE_US) && defined(MATRIX_COL_PINS)
+    matrix_calibrate_settle();
+#        endif
 
 #    elif (DIODE_DIRECTION == ROW2COL)
     /* ROW2COL: rows are inputs (pull-up), cols are outputs (idle HIGH) */
@@ -102,13 +322,66 @@ void matrix_init_custom(void) {
 #    else
 #        error "DIODE_DIRECTION must be COL2ROW or ROW2COL"
 #    endif
+#endif
+
+#ifdef MATRIX_BULK_READ
+#    ifdef DIRECT_PINS
+    for (uint8_t r = 0; r < ROWS_PER_HAND_LOCAL; r++) {
+        bulk_group_setup(&direct_groups[r], direct_pins[r]);
+    }
+#    endif
+#    if defined(MATRIX_COL_PINS) && defined(DIODE_DIRECTION) && (DIODE_DIRECTION == COL2ROW)
+    bulk_group_setup(&col_group, matrix_col_pins);
+#    endif
 #endif
 
     /* Clear last_matrix */
     for (uint8_t r = 0; r < MATRIX_ROWS; r++) last_matrix[r] = 0;
 }
 
+#if defined(MATRIX_ROW_PINS) && defined(DIODE_DIRECTION) && (DIODE_DIRECTION == COL2ROW)
+/* COL2ROW: drive each row low in turn and read the columns */
+static void matrix_scan_rows(matrix_row_t current_matrix[]) {
+#    ifdef MATRIX_IDLE_SCAN
+    if (matrix_idle) {
+        if (!matrix_wake_pending && matrix_read_cols() == 0) {
+            /* Every row is held low, so quiet columns mean nothing is pressed */
+            return;
+        }
+        matrix_idle_exit();
+    }
+#    endif
+
+    pin_t prev_row = NO_PIN;
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        pin_t rp = matrix_row_pins[r];
+        if (rp == NO_PIN) continue;
+
+        /* Release the previous row and select this one back to back. One settle
+         * wait covers both the columns recovering from row N-1 and row N settling. */
+        if (prev_row != NO_PIN) gpio_write_pin_high(prev_row);
+        gpio_write_pin_low(rp);
+        wait_us(matrix_settle_us);
+
+#    ifdef MATRIX_COL_PINS
+        current_matrix[r] |= matrix_read_cols();
+#    endif
+
+        prev_row = rp;
+    }
+    /* Leave every row released; the next scan's first settle wait covers recovery */
+    if (prev_row != NO_PIN) gpio_write_pin_high(prev_row);
+}
+#endif
+
 bool matrix_scan_custom(matrix_row_t current_matrix[]) {
+    if (!sof_sync_due()) {
+        /* Not this frame's slot yet: report the last scan unchanged */
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) current_matrix[r] = last_matrix[r];
+        return false;
+    }
+
+    PROFILE_START(profile_start);
     bool changed = false;
 
     /* Start with zeros */
@@ -116,7 +389,24 @@ bool matrix_scan_custom(matrix_row_t current_matrix[]) {
 
     /* Read direct pins and OR into current_matrix */
 #ifdef DIRECT_PINS
+#    ifdef MATRIX_BULK_READ
+    /* Rows sharing a port (B0-B7 / B8-B15) reuse one IDR snapshot */
+    ioportid_t   cached_port = NULL;
+    ioportmask_t cached_idr  = 0;
+#    endif
     for (uint8_t r = 0; r < ROWS_PER_HAND_LOCAL; r++) {
+#    ifdef MATRIX_BULK_READ
+        const bulk_group_t *g = &direct_groups[r];
+        if (g->ok) {
+            if (g->mask == 0) continue;
+            if (g->port != cached_port) {
+                cached_port = g->port;
+                cached_idr  = palReadPort(g->port);
+            }
+            current_matrix[r] |= bulk_group_extract(g, cached_idr);
+            continue;
+        }
+#    endif
         for (uint8_t c = 0; c < MATRIX_COLS; c++) {
             pin_t p = direct_pins[r][c];
             if (p == NO_PIN) continue;
@@ -133,29 +423,7 @@ bool matrix_scan_custom(matrix_row_t current_matrix[]) {
 #    if (DIODE_DIRECTION == COL2ROW)
     /* For each row: drive row low, read columns */
 #        ifdef MATRIX_ROW_PINS
-    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
-        pin_t rp = matrix_row_pins[r];
-        if (rp == NO_PIN) continue;
-        
-        /* Select row: Set as Output and Drive Low */
-        gpio_set_pin_output(rp);
-        gpio_write_pin_low(rp);
-        wait_us(30);  /* delay for signal settling */
-        
-#            ifdef MATRIX_COL_PINS
-        for (uint8_t c = 0; c < MATRIX_COLS; c++) {
-            pin_t cp = matrix_col_pins[c];
-            if (cp == NO_PIN) continue;
-            if (!gpio_read_pin(cp)) {
-                current_matrix[r] |= ((matrix_row_t)1 << c);
-            }
-        }
-#            endif
-        
-        /* Unselect row: Set back to Input (Hi-Z) */
-        gpio_set_pin_input(rp);
-        wait_us(30);  /* delay before next row */
-    }
+    matrix_scan_rows(current_matrix);
 #        else
 #            error "MATRIX_ROW_PINS must be defined for COL2ROW"
 #        endif
@@ -196,6 +464,22 @@ bool matrix_scan_custom(matrix_row_t current_matrix[]) {
             last_matrix[r] = current_matrix[r];
         }
     }
+    if (changed) latency_matrix_changed();
+
+#ifdef MATRIX_IDLE_SCAN
+    if (!matrix_idle) {
+        bool any_pressed = false;
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            if (current_matrix[r]) any_pressed = true;
+        }
+        if (any_pressed) {
+            matrix_active_time = timer_read();
+        } else if (timer_elapsed(matrix_active_time) >= MATRIX_IDLE_TIMEOUT) {
+            matrix_idle_enter();
+        }
+    }
+#endif
 
+    PROFILE_STOP(PROFILE_MATRIX_SCAN, profile_start);
     return changed;
 }
\ No newline at end of file
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdbool.h>
+
+/*
+ * Interrupt-armed idle mode of the COL2ROW scan in matrix.c (see
+ * MATRIX_IDLE_TIMEOUT there).
+ */
+
+// True while every row is held low with the column edge events armed and no
+// edge is waiting for a scan, so any matrix key press raises an EXTI edge.
+// Always false when the idle mode is not compiled in.
+bool matrix_idle_armed(void);
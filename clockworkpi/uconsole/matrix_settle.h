@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * COL2ROW settle wait used by matrix.c between selecting a row and reading the
+ * columns. With MATRIX_SETTLE_US undefined it is calibrated at init from the
+ * column pull-up recovery, times MATRIX_SETTLE_FACTOR, and clamped to
+ * MATRIX_SETTLE_MIN_US..MAX_US.
+ */
+
+// Settle wait in use, in microseconds
+uint8_t matrix_settle_time(void);
+// Prints the settle wait in use and the calibrated value on the console
+void matrix_settle_print(void);
@@ -3,4 +3,10 @@
 #include_next <mcuconf.h>
 
 #undef STM32_PWM_USE_TIM1
-#define STM32_PWM_USE_TIM1 TRUE
\ No newline at end of file
+#define STM32_PWM_USE_TIM1 TRUE
+
+// The backlight fades feed TIM1 CCR1 from DMA1 channel 5 (uconsole.c)
+#ifdef BACKLIGHT_ENABLE
+#    undef STM32_DMA_REQUIRED
+#    define STM32_DMA_REQUIRED TRUE
+#endif
@@ -0,0 +1,159 @@
+#include "quantum.h"
+#include "usb_main.h"
+#include "hrtimer.h"
+#include "power.h"
+#include "matrix_idle.h"
+
+// STOP wakeup before the first instruction runs, which the core cannot time
+// itself: datasheet t_WUSTOP with the regulator in low power mode (typical)
+#define POWER_STOP_WAKEUP_US 5
+
+static bool     power_idle = false;
+static uint32_t power_last_activity = 0;
+
+// Set when a sleep ends; the next input activity closes a wake sample
+static bool     power_woke = false;
+static uint32_t power_wake_time = 0;
+static stats_t  power_wake_stats;
+static stats_t  power_restart_stats; // clock restart after STOP
+
+// Direct keys whose EXTI lines (12-15) nothing else uses; armed during STOP only
+static const ioline_t power_wake_lines[] = {
+    PAL_LINE(GPIOB, 12U),
+    PAL_LINE(GPIOB, 13U),
+    PAL_LINE(GPIOB, 14U),
+    PAL_LINE(GPIOB, 15U),
+};
+
+#ifdef BACKLIGHT_BREATHING
+static bool power_breathing = false;
+#endif
+
+static void power_wake_cb(void *arg) {
+    (void)arg;
+}
+
+// lead_us: time the MCU was already awake before the timer could be read
+static void power_sleep_done(uint32_t lead_us) {
+    power_wake_time = hrtimer_read() - lead_us;
+    power_woke      = true;
+}
+
+static void power_idle_enter(void) {
+#ifdef BACKLIGHT_ENABLE
+#    ifdef BACKLIGHT_BREATHING
+    power_breathing = is_breathing();
+    if (power_breathing) breathing_disable();
+#    endif
+    backlight_set(0);
+#endif
+    power_idle = true;
+}
+
+static void power_idle_exit(void) {
+#ifdef BACKLIGHT_ENABLE
+    backlight_set(is_backlight_enabled() ? get_backlight_level() : 0);
+#    ifdef BACKLIGHT_BREATHING
+    if (power_breathing) breathing_enable();
+#    endif
+#endif
+    power_idle = false;
+}
+
+void power_task(void) {
+    const uint32_t activity = last_input_activity_time();
+    if (activity != power_last_activity) {
+        // This pass produced input; its report has already gone out
+        power_last_activity = activity;
+        if (power_woke) stats_add(&power_wake_stats, hrtimer_read() - power_wake_time);
+        power_woke = false;
+        if (power_idle) power_idle_exit();
+        return;
+    }
+
+    if (!power_idle) {
+        if (POWER_IDLE_TIMEOUT_MS > 0 && last_input_activity_elapsed() >= POWER_IDLE_TIMEOUT_MS) {
+            power_idle_enter();
+        }
+        return;
+    }
+
+#if CH_CFG_ST_TIMEDELTA == 0
+    // The periodic system tick bounds the sleep, so the direct keys, which
+    // have no EXTI, are still polled every tick
+    __WFI();
+    power_sleep_done(0);
+#else
+#    error "The idle WFI relies on the periodic system tick; set CH_CFG_ST_TIMEDELTA to 0 (see chconf.h)"
+#endif
+}
+
+static void power_stop(void) {
+    if (USB_DRIVER.state != USB_SUSPENDED) return;
+#ifdef BACKLIGHT_ENABLE
+    // TIM1 halts in STOP and would hold the pin where the fade out has got to
+    if (TIM1->CCR1 != 0) return;
+#endif
+    // STOP halts the scan, so only the matrix idle mode's column edges can see
+    // a key press. Until the scan has armed it (MATRIX_IDLE_TIMEOUT ms after
+    // the last key, or never with it set to 0), sleep only to the next tick.
+    if (!matrix_idle_armed()) {
+        __WFI();
+        power_sleep_done(0);
+        return;
+    }
+
+    for (uint8_t i = 0; i < ARRAY_SIZE(power_wake_lines); i++) {
+        palEnableLineEvent(power_wake_lines[i], PAL_EVENT_MODE_FALLING_EDGE);
+        palSetLineCallback(power_wake_lines[i], power_wake_cb, NULL);
+    }
+    // USB resume reaches EXTI line 18 as a wake-up event (no handler needed)
+    EXTI->RTSR |= EXTI_RTSR_TR18;
+    EXTI->EMR |= EXTI_EMR_MR18;
+
+    // The cycle counter times the clock restart (no-op if profiling enabled it)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    PWR->CR = (PWR->CR & ~PWR_CR_PDDS) | PWR_CR_LPDS | PWR_CR_CWUF;
+    SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+    __SEV();
+    __WFE(); // clears the event register
+    __WFE();
+    const uint32_t woke = DWT->CYCCNT;
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+
+    // STOP leaves the core on HSI; bring back HSE and the PLL. Until the
+    // switch at the end the core and the hrtimer run at 8 MHz instead of
+    // 72 MHz, so the restart is timed in HSI cycles.
+    stm32_clock_init();
+    const uint32_t restart_us = (DWT->CYCCNT - woke) / (STM32_HSICLK / 1000000);
+    stats_add(&power_restart_stats, restart_us);
+
+    EXTI->EMR &= ~EXTI_EMR_MR18;
+    EXTI->PR = EXTI_PR_PR18;
+    for (uint8_t i = 0; i < ARRAY_SIZE(power_wake_lines); i++) {
+        palDisableLineEvent(power_wake_lines[i]);
+    }
+    power_sleep_done(POWER_STOP_WAKEUP_US + restart_us);
+}
+
+void suspend_power_down_kb(void) {
+    power_stop();
+    suspend_power_down_user();
+}
+
+void power_reset(void) {
+    stats_reset(&power_wake_stats);
+    stats_reset(&power_restart_stats);
+}
+
+void power_print(void) {
+    stats_print("wake_to_report", "us", &power_wake_stats);
+    stats_print("stop_clock_restart", "us", &power_restart_stats);
+}
+
+bool power_get(stats_t *out) {
+    *out = power_wake_stats;
+    return true;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "stats.h"
+
+/*
+ * Idle power saving.
+ *
+ * The USB peripheral needs its 48 MHz clock to answer the host every frame,
+ * so the low power states follow the bus:
+ *
+ * - Host active, no key or trackball input for POWER_IDLE_TIMEOUT_MS: the
+ *   backlight fades out and the main loop sleeps (WFI) after every pass. The
+ *   system tick, USB and the matrix/trackball EXTIs end each sleep, so input
+ *   is still picked up on the next pass. Any input restores the backlight.
+ * - Host suspended the bus: suspend loop passes enter STOP mode once the
+ *   matrix idle mode is armed (matrix_idle_armed(): every row held low, column
+ *   edges armed) and sleep with WFI until the next tick before that. Wake
+ *   sources are the matrix columns, the trackball lines, the direct keys
+ *   B12-B15 and USB resume signalling. The other direct keys (B0-B11, C12)
+ *   share EXTI lines with the columns and trackball and cannot wake the MCU. Trackball edges that arrive during STOP
+ *   are queued and kept, and so is the key that woke the MCU, since it is
+ *   still held when the suspend loop scans the matrix. Only keys issue a
+ *   remote wakeup; QMK does not check the pointing device for that.
+ *
+ * The time from the wake-up to the first input-driven report is kept in a
+ * histogram (power_print(), raw HID stats). After STOP it includes the STOP
+ * wakeup itself (datasheet t_WUSTOP, 5.4 us typical, added as a constant) and
+ * the clock restart: HSE start-up (t_SU(HSE), ~2 ms typical) and PLL lock
+ * (200 us max), timed in core cycles while the core runs on the HSI. The
+ * restart alone is printed as stop_clock_restart. These are datasheet
+ * figures; the latency has not been measured on a device yet.
+ *
+ * The WFI idle relies on the periodic system tick to keep polling the direct
+ * keys; chconf.h pins CH_CFG_ST_TIMEDELTA to 0 and power.c fails to build
+ * without it.
+ *
+ * Set POWER_IDLE_TIMEOUT_MS to 0 to keep the backlight and main loop running.
+ */
+#ifndef POWER_IDLE_TIMEOUT_MS
+#    define POWER_IDLE_TIMEOUT_MS 30000
+#endif
+
+void power_task(void);
+void power_reset(void);
+void power_print(void);
+bool power_get(stats_t *out);
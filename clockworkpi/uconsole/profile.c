@@ -0,0 +1,59 @@
+#include "quantum.h"
+#include "profile.h"
+#include "stats.h"
+
+#ifdef PROFILE_ENABLE
+
+static stats_t profile_stats[PROFILE_NUM];
+
+static const char *const profile_names[PROFILE_NUM] = {
+    [PROFILE_MATRIX_SCAN]    = "matrix_scan",
+    [PROFILE_TB_LEFT]        = "tb_left",
+    [PROFILE_TB_RIGHT]       = "tb_right",
+    [PROFILE_TB_UP]          = "tb_up",
+    [PROFILE_TB_DOWN]        = "tb_down",
+    [PROFILE_GET_REPORT]     = "get_report",
+    [PROFILE_PROCESS_RECORD] = "process_record",
+};
+
+void profile_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    profile_reset();
+}
+
+// Each point has a single writer (the main loop or one EXTI vector), so only
+// reset and print need to keep the ISR points out.
+void profile_record(profile_point_t point, uint32_t cycles) {
+    stats_add(&profile_stats[point], cycles);
+}
+
+void profile_reset(void) {
+    chSysLock();
+    for (uint8_t i = 0; i < PROFILE_NUM; i++) {
+        stats_reset(&profile_stats[i]);
+    }
+    chSysUnlock();
+}
+
+bool profile_get(uint8_t point, stats_t *out) {
+    if (point >= PROFILE_NUM) return false;
+    chSysLock();
+    *out = profile_stats[point];
+    chSysUnlock();
+    return true;
+}
+
+void profile_print(void) {
+    uprintf("cycles @ %lu Hz\n", (unsigned long)STM32_SYSCLK);
+    for (uint8_t i = 0; i < PROFILE_NUM; i++) {
+        stats_t snapshot;
+        chSysLock();
+        snapshot = profile_stats[i];
+        chSysUnlock();
+        stats_print(profile_names[i], "cyc", &snapshot);
+    }
+}
+
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "quantum.h"
+#include "stats.h"
+
+/*
+ * Opt-in cycle counting of the hot paths (PROFILE_ENABLE = yes in rules.mk).
+ *
+ * Uses the Cortex-M3 DWT cycle counter, so one count is one core clock
+ * (1 ms USB frame = 72000 cycles at 72 MHz). Results are printed on the
+ * console with profile_print(). With profiling disabled every hook compiles
+ * away.
+ */
+typedef enum {
+    PROFILE_MATRIX_SCAN,    // matrix_scan_custom()
+    PROFILE_TB_LEFT,        // trackball EXTI callbacks
+    PROFILE_TB_RIGHT,
+    PROFILE_TB_UP,
+    PROFILE_TB_DOWN,
+    PROFILE_GET_REPORT,     // pointing_device_driver_get_report()
+    PROFILE_PROCESS_RECORD, // process_record_user()
+    PROFILE_NUM
+} profile_point_t;
+
+#ifdef PROFILE_ENABLE
+void profile_init(void);
+void profile_record(profile_point_t point, uint32_t cycles);
+void profile_reset(void);
+void profile_print(void);
+// Copies one point's stats; false if `point` is out of range
+bool profile_get(uint8_t point, stats_t *out);
+
+#    define PROFILE_START(var) const uint32_t var = DWT->CYCCNT
+#    define PROFILE_STOP(point, var) profile_record(point, DWT->CYCCNT - (var))
+#else
+static inline void profile_init(void) {}
+static inline void profile_reset(void) {}
+static inline void profile_print(void) {}
+static inline bool profile_get(uint8_t point, stats_t *out) {
+    return false;
+}
+
+#    define PROFILE_START(var)
+#    define PROFILE_STOP(point, var)
+#endif
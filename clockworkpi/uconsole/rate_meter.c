@@ -1,41 +1,58 @@
-#include "quantum.h"
 #include "rate_meter.h"
 
-void rate_meter_interrupt(rate_meter_t* rm) {
-  uint16_t now = timer_read();
-  if (timeout_get(rm->cutoff)) {
-    rm->average_delta = CUTOFF_MS;
+static inline int64_t clamp_i64(int64_t x, int64_t lo, int64_t hi) {
+  return x < lo ? lo : x > hi ? hi : x;
+}
+
+void rate_meter_interrupt(rate_meter_t* rm, uint32_t now_us) {
+  const bool expired = timeout_get(rm->cutoff);
+  const uint32_t delta = (uint32_t)clamp_i64((uint32_t)(now_us - rm->last_time_us), RATE_METER_MIN_DELTA_US, CUTOFF_US);
+
+  if (expired) {
+    // First edge of a movement: nothing to measure yet, assume the slowest rate
+    rm->velocity = (fix16_t)(((int64_t)1000000 << FIX16_SHIFT) / CUTOFF_US);
+    rm->error = 0;
+    rm->primed = false;
+  } else if (!rm->primed) {
+    rm->velocity = (fix16_t)(((int64_t)1000000 << FIX16_SHIFT) / delta);
+    rm->error = 0;
+    rm->primed = true;
   } else {
-    uint16_t delta = MIN(TIMER_DIFF_16(now, rm->last_time_millis), CUTOFF_MS);
-    // Smoother weighted average: 75% previous state, 25% new input
-    rm->average_delta = (rm->average_delta * 3 + delta) / 4;
+    // Residual of the prediction: estimate + v * dt - (counted + 1)
+    const fix16_t predicted = rm->error + (fix16_t)(((int64_t)rm->velocity * delta) / 1000000);
+    const fix16_t residual = predicted - FIX16_ONE;
+
+    rm->error = residual - (residual >> RATE_METER_ALPHA_SHIFT);
+    int64_t velocity = rm->velocity - ((int64_t)residual * 1000000) / ((int64_t)RATE_METER_BETA_DIV * delta);
+    rm->velocity = (fix16_t)clamp_i64(velocity, 0, RATE_METER_MAX_RATE);
   }
-  rm->last_time_millis = now;
+
+  rm->last_time_us = now_us;
   rm->cutoff = timeout_reset();
 }
 
 void rate_meter_tick(rate_meter_t* rm, millis_t delta) {
   rm->cutoff = timeout_update(rm->cutoff, delta);
-  if (!timeout_get(rm->cutoff)) {
-    // Gradually increase average_delta when no movement is detected to slow down glide
-    rm->average_delta += delta;
-  }
 }
 
 void rate_meter_expire(rate_meter_t* rm) {
   rm->cutoff = timeout_expire();
 }
 
-uint16_t rate_meter_delta(rate_meter_t* rm) {
-  return rm->average_delta;
+uint32_t rate_meter_delta(rate_meter_t* rm) {
+  if (timeout_get(rm->cutoff) || rm->velocity <= 0) return CUTOFF_US;
+  const uint64_t delta = (((uint64_t)1000000 << FIX16_SHIFT) / (uint32_t)rm->velocity) << RATE_METER_GAIN_SHIFT;
+  return (uint32_t)clamp_i64((int64_t)delta, RATE_METER_MIN_DELTA_US, CUTOFF_US);
 }
 
-float rate_meter_rate(rate_meter_t* rm) {
+fix16_t rate_meter_rate(rate_meter_t* rm, uint32_t now_us) {
   if (timeout_get(rm->cutoff)) {
-    return 0.0f;
-  } else if (rm->average_delta == 0) {
-    return 1000.0f;
-  } else {
-    return 1000.0f / (float)rm->average_delta;
+    return 0;
   }
-}
\ No newline at end of file
+  const uint32_t idle = now_us - rm->last_time_us;
+  if (idle <= RATE_METER_MIN_DELTA_US) {
+    return rm->velocity >> RATE_METER_GAIN_SHIFT;
+  }
+  const fix16_t bound = (fix16_t)(((uint64_t)1000000 << FIX16_SHIFT) / idle);
+  return (rm->velocity < bound ? rm->velocity : bound) >> RATE_METER_GAIN_SHIFT;
+}
@@ -1,13 +1,50 @@
 #include "timeout.h"
+#include "fixed_point.h"
 
+#define CUTOFF_US ((uint32_t)CUTOFF_MS * 1000)
+// Floor on the edge interval, caps the rate at 4000 edges/s per axis so the
+// velocity curve stays inside Q16.16.
+#define RATE_METER_MIN_DELTA_US 250
+#define RATE_METER_MAX_RATE ((fix16_t)((1000000 / RATE_METER_MIN_DELTA_US) << FIX16_SHIFT))
+
+// Alpha-beta tracker gains: alpha = 1/2 corrects half the position residual
+// per edge, beta = 1/6 feeds a sixth of it (per interval) into the velocity.
+// Together they settle within a few edges without ringing.
+#define RATE_METER_ALPHA_SHIFT 1
+#define RATE_METER_BETA_DIV 6
+
+// The velocity curve and the glider sustain are tuned for the EWMA meter this
+// replaced, which settled at four times the true edge interval (its idle-tick
+// growth kept it there). Reported rates are divided, and intervals multiplied,
+// by 1 << RATE_METER_GAIN_SHIFT so steady motion keeps the same cursor speed.
+#define RATE_METER_GAIN_SHIFT 2
+
+/*
+ * Per-axis edge rate estimator: an alpha-beta tracker on the edge count.
+ *
+ * Each edge is a position measurement one step past the previous one; the
+ * tracker predicts where it should have been from the current velocity and
+ * corrects both position and velocity by the residual. The first interval
+ * after a restart seeds the velocity directly, so a flick is tracked from its
+ * second edge. Between edges the reported rate is bounded by 1/(time since
+ * the last edge): if no edge came for that long, the ball cannot be faster.
+ * This is what brings the other axis of a diagonal down promptly when it
+ * stops, instead of coasting on its last estimate.
+ */
 typedef struct {
-  uint16_t last_time_millis;
-  uint16_t average_delta;
+  uint32_t last_time_us;
+  fix16_t velocity;  // edges/s
+  fix16_t error;     // position estimate minus edges counted, in edges
+  bool primed;       // velocity seeded from a measured interval
   timeout_t cutoff;
 } rate_meter_t;
 
-void rate_meter_interrupt(rate_meter_t* rm);
+void rate_meter_interrupt(rate_meter_t* rm, uint32_t now_us);
 void rate_meter_tick(rate_meter_t* rm, millis_t delta);
 void rate_meter_expire(rate_meter_t* rm);
-uint16_t rate_meter_delta(rate_meter_t* rm);
-float rate_meter_rate(rate_meter_t* rm);
+// Estimated edge interval in microseconds, RATE_METER_MIN_DELTA_US..CUTOFF_US,
+// scaled by RATE_METER_GAIN_SHIFT
+uint32_t rate_meter_delta(rate_meter_t* rm);
+// Curve input rate in Q16.16 as of now_us (edges per second scaled down by
+// RATE_METER_GAIN_SHIFT), 0 once the cutoff expired
+fix16_t rate_meter_rate(rate_meter_t* rm, uint32_t now_us);
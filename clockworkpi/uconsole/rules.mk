@@ -1,6 +1,48 @@
+SRC += hrtimer.c kb_config.c hid_protocol.c gamepad.c power.c
+
 CUSTOM_MATRIX = lite
 SRC += matrix.c
 
+# debounce_type "custom": per-key adaptive windows (adaptive, see
+# debounce_adaptive.h) or a fixed DEBOUNCE ms window run with bit-parallel
+# counters (vertical, see debounce_vertical.c)
+DEBOUNCE_ALGORITHM ?= adaptive
+ifeq ($(strip $(DEBOUNCE_ALGORITHM)), vertical)
+    SRC += debounce_vertical.c
+else
+    OPT_DEFS += -DDEBOUNCE_ADAPTIVE
+    SRC += debounce_adaptive.c
+endif
+
 BACKLIGHT_DRIVER = custom
 POINTING_DEVICE_DRIVER = custom
-SRC += timeout.c rate_meter.c glider.c trackball.c
\ No newline at end of file
+SRC += fixed_point.c timeout.c rate_meter.c glider.c trackball_curve.c trackball_motion.c edge_queue.c trackball.c
+SRC += stats.c
+
+# DWT cycle counts of the scan, EXTI, report and record paths, see profile.h
+PROFILE_ENABLE ?= no
+ifeq ($(strip $(PROFILE_ENABLE)), yes)
+    OPT_DEFS += -DPROFILE_ENABLE
+    SRC += profile.c
+endif
+
+# Matrix change to USB keyboard report latency, see latency.h
+LATENCY_ENABLE ?= no
+ifeq ($(strip $(LATENCY_ENABLE)), yes)
+    OPT_DEFS += -DLATENCY_ENABLE
+    SRC += latency.c
+endif
+
+# RAM capture of raw trackball edges, read over raw HID, see edge_record.h
+EDGE_RECORD_ENABLE ?= no
+ifeq ($(strip $(EDGE_RECORD_ENABLE)), yes)
+    OPT_DEFS += -DEDGE_RECORD_ENABLE
+    SRC += edge_record.c
+endif
+
+# Align the matrix scan and pointing report to the USB frame, see sof_sync.h
+SOF_SYNC_ENABLE ?= no
+ifeq ($(strip $(SOF_SYNC_ENABLE)), yes)
+    OPT_DEFS += -DSOF_SYNC_ENABLE
+    SRC += sof_sync.c
+endif
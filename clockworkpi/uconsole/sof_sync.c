@@ -0,0 +1,80 @@
+#include "quantum.h"
+#include "usb_main.h"
+#include "hrtimer.h"
+#include "sof_sync.h"
+
+#ifdef SOF_SYNC_ENABLE
+
+#    define SOF_PERIOD_US 1000U
+#    define SOF_FRAME_MASK USB_FNR_FN
+
+_Static_assert(SOF_SYNC_LEAD_US < SOF_PERIOD_US, "SOF_SYNC_LEAD_US must be shorter than a frame");
+
+static bool     sof_locked = false;
+static uint16_t sof_frame  = 0; // frame number of sof_time
+static uint32_t sof_time   = 0; // estimated hrtimer time of the start of sof_frame
+static uint32_t sof_seen   = 0; // hrtimer time of the last call
+static uint16_t sof_served = 0; // frame whose end-of-frame slot the last scan used
+static bool     sof_slot   = true; // last sof_sync_due() answer
+
+static inline uint16_t sof_read_frame(void) {
+    return USB->FNR & SOF_FRAME_MASK;
+}
+
+static bool sof_sync_check(void) {
+    if (USB_DRIVER.state != USB_ACTIVE) {
+        sof_locked = false;
+        return true;
+    }
+
+    const uint16_t frame = sof_read_frame();
+    const uint32_t now   = hrtimer_read();
+    const uint32_t since = now - sof_seen;
+    sof_seen             = now;
+
+    if (!sof_locked) {
+        // Wait for a frame edge between two calls to take the phase from
+        if (frame != sof_frame && since <= SOF_PERIOD_US) {
+            sof_time   = now;
+            sof_locked = true;
+        }
+        sof_frame  = frame;
+        sof_served = frame;
+        return true;
+    }
+
+    if (frame != sof_frame) {
+        // Predict the latest edge, then move it into (last call, now], where it
+        // was observed. The loop calls often, so this keeps the phase within
+        // one pass of the true edge and follows the drift between the two
+        // clocks; after a long pass the bracket is wide but still holds.
+        const uint16_t frames = (frame - sof_frame) & SOF_FRAME_MASK;
+        sof_time += frames * SOF_PERIOD_US;
+        if ((int32_t)(sof_time - (now - since)) <= 0) sof_time = now - since + 1;
+        if ((int32_t)(sof_time - now) > 0) sof_time = now;
+        sof_frame = frame;
+    } else if (now - sof_time > 2 * SOF_PERIOD_US) {
+        // No SOF for two frames (host gone quiet): scan on every pass
+        sof_locked = false;
+        return true;
+    }
+
+    // One scan per frame, in the slot SOF_SYNC_LEAD_US before its end; a frame
+    // whose slot passed during a long pass is scanned right away
+    if (frame == sof_served || (int32_t)(now - (sof_time + SOF_PERIOD_US - SOF_SYNC_LEAD_US)) < 0) {
+        return false;
+    }
+    sof_served = frame;
+    return true;
+}
+
+bool sof_sync_due(void) {
+    sof_slot = sof_sync_check();
+    return sof_slot;
+}
+
+bool sof_sync_slot(void) {
+    return sof_slot;
+}
+
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdbool.h>
+
+/*
+ * Opt-in USB frame alignment of the matrix scan (SOF_SYNC_ENABLE = yes in
+ * rules.mk).
+ *
+ * The host polls the interrupt endpoints once per 1 ms frame, so a scan done
+ * right after the poll waits almost a full frame to be reported.
+ * sof_sync_due() is checked at the top of every matrix scan and lets one scan
+ * per frame through, the first one from SOF_SYNC_LEAD_US before the next
+ * start-of-frame. The scan then finishes just ahead of the next poll instead
+ * of at a random phase. Passes before the slot skip the scan and return the
+ * previous matrix, so the loop never waits here and the rest of the main
+ * loop (and the idle sleep in power.c) keeps running.
+ *
+ * The SOF interrupt belongs to the USB stack, so frame boundaries are found
+ * by reading the USB frame number register (FNR) against the microsecond
+ * timer on every call. A frame edge is predicted in 1000 us steps and pulled
+ * into the interval between the two calls that saw the frame number change,
+ * which corrects the drift between the two clocks as it goes. Without SOFs
+ * (bus suspended, host gone quiet) every pass scans.
+ *
+ * sof_sync_slot() repeats the last sof_sync_due() answer for the rest of the
+ * main loop pass, so the pointing report is built on the same pass as the
+ * scan and both go out in the same frame.
+ */
+#ifndef SOF_SYNC_LEAD_US
+#    define SOF_SYNC_LEAD_US 300
+#endif
+
+#ifdef SOF_SYNC_ENABLE
+bool sof_sync_due(void);
+bool sof_sync_slot(void);
+#else
+static inline bool sof_sync_due(void) {
+    return true;
+}
+static inline bool sof_sync_slot(void) {
+    return true;
+}
+#endif
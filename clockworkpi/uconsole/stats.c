@@ -0,0 +1,34 @@
+#include "quantum.h"
+#include "stats.h"
+
+void stats_reset(stats_t *s) {
+    memset(s, 0, sizeof(*s));
+}
+
+void stats_add(stats_t *s, uint32_t sample) {
+    if (s->count == 0 || sample < s->min) s->min = sample;
+    if (sample > s->max) s->max = sample;
+    s->count++;
+    s->sum += sample;
+
+    uint8_t bucket = sample ? 32 - __builtin_clz(sample) : 0;
+    if (bucket >= STATS_BUCKETS) bucket = STATS_BUCKETS - 1;
+    if (s->hist[bucket] < UINT16_MAX) s->hist[bucket]++;
+}
+
+void stats_print(const char *name, const char *unit, const stats_t *s) {
+    if (s->count == 0) {
+        uprintf("%s: no samples\n", name);
+        return;
+    }
+    uprintf("%s: n=%lu min=%lu avg=%lu max=%lu %s |", name, (unsigned long)s->count, (unsigned long)s->min, (unsigned long)(s->sum / s->count), (unsigned long)s->max, unit);
+    for (uint8_t b = 0; b < STATS_BUCKETS; b++) {
+        if (s->hist[b] == 0) continue;
+        if (b == STATS_BUCKETS - 1) {
+            uprintf(" >=%lu:%u", 1UL << (b - 1), s->hist[b]);
+        } else {
+            uprintf(" <%lu:%u", 1UL << b, s->hist[b]);
+        }
+    }
+    uprintf("\n");
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+
+#define STATS_BUCKETS 20
+
+/*
+ * Running count/min/avg/max of unsigned samples plus a log2 histogram.
+ * Bucket 0 counts zeros, bucket n counts samples in [2^(n-1), 2^n) and the
+ * last bucket takes everything above. Bucket counts saturate at UINT16_MAX.
+ *
+ * Not thread safe: callers that add from an ISR and read from the main loop
+ * must copy or reset under a lock.
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint16_t hist[STATS_BUCKETS];
+} stats_t;
+
+void stats_reset(stats_t *s);
+void stats_add(stats_t *s, uint32_t sample);
+// Prints one console line: name, count, min/avg/max and the non-empty buckets
+void stats_print(const char *name, const char *unit, const stats_t *s);
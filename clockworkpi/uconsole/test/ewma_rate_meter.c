@@ -0,0 +1,47 @@
+/*
+ * The EWMA rate meter the alpha-beta tracker replaced, on the current API, so
+ * replay can compare the two (make compare). The averaged edge interval lives
+ * in the tracker's error field.
+ */
+#include "rate_meter.h"
+
+#define average_delta error
+
+static inline uint32_t min_u32(uint32_t a, uint32_t b) {
+  return a < b ? a : b;
+}
+
+void rate_meter_interrupt(rate_meter_t* rm, uint32_t now_us) {
+  if (timeout_get(rm->cutoff)) {
+    rm->average_delta = CUTOFF_US;
+  } else {
+    uint32_t delta = min_u32(now_us - rm->last_time_us, CUTOFF_US);
+    rm->average_delta = (rm->average_delta * 3 + delta) / 4;
+  }
+  rm->last_time_us = now_us;
+  rm->cutoff = timeout_reset();
+}
+
+void rate_meter_tick(rate_meter_t* rm, millis_t delta) {
+  rm->cutoff = timeout_update(rm->cutoff, delta);
+  if (!timeout_get(rm->cutoff)) {
+    rm->average_delta = min_u32((uint32_t)rm->average_delta + (uint32_t)delta * 1000, CUTOFF_US);
+  }
+}
+
+void rate_meter_expire(rate_meter_t* rm) {
+  rm->cutoff = timeout_expire();
+}
+
+uint32_t rate_meter_delta(rate_meter_t* rm) {
+  return rm->average_delta;
+}
+
+fix16_t rate_meter_rate(rate_meter_t* rm, uint32_t now_us) {
+  if (timeout_get(rm->cutoff)) {
+    return 0;
+  }
+  uint32_t delta = (uint32_t)rm->average_delta;
+  if (delta < RATE_METER_MIN_DELTA_US) delta = RATE_METER_MIN_DELTA_US;
+  return (fix16_t)(((uint64_t)1000000 << FIX16_SHIFT) / delta);
+}
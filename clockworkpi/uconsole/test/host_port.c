@@ -0,0 +1,157 @@
+/*
+ * Simulated GPIO ports for host builds of matrix.c.
+ *
+ * The key state is the ground truth: direct pins read low while their key is
+ * held, and a column reads low while a held key connects it to a row that is
+ * driven low. A column that stops being pulled low reads low for another
+ * host_col_recovery_us, like the pull-up recharging the line, so a settle wait
+ * that is too short shows up as ghost keys. Falling edges on armed lines call
+ * their PAL callback, like the EXTI would.
+ */
+#include "host_port.h"
+#include "hrtimer.h"
+
+#define PORT_NUM 3
+
+host_gpio_t host_gpio[PORT_NUM] = {{0}, {1}, {2}};
+
+bool     host_keys[MATRIX_ROWS][MATRIX_COLS];
+uint32_t host_time_us        = 0;
+uint32_t host_port_callbacks = 0;
+uint32_t host_col_recovery_us = 0;
+
+static const pin_t row_pins[MATRIX_ROWS] = MATRIX_ROW_PINS;
+static const pin_t col_pins[MATRIX_COLS] = MATRIX_COL_PINS;
+static const pin_t direct_pins[MATRIX_ROWS][MATRIX_COLS] = DIRECT_PINS;
+
+typedef struct {
+    bool output;
+    bool level; // output level
+    bool armed;
+    bool last;  // level seen by the edge detector
+    bool pulled;        // column held low on the last evaluation
+    uint32_t recovered; // host_time_us at which a released column reads high
+    void (*cb)(void *);
+    void *arg;
+} host_pin_t;
+
+static host_pin_t pins[PORT_NUM * 16];
+
+void host_advance_us(uint32_t us) {
+    host_time_us += us;
+}
+
+// Every read takes a microsecond, so polling loops on the timer make progress
+uint32_t hrtimer_read(void) {
+    return host_time_us++;
+}
+
+static bool column_pulled(pin_t pin) {
+    for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+        if (col_pins[c] != pin) continue;
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            const pin_t rp = row_pins[r];
+            if (rp != NO_PIN && pins[rp].output && !pins[rp].level && host_keys[r][c]) return true;
+        }
+        return false;
+    }
+    return false;
+}
+
+static bool is_column(pin_t pin) {
+    for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+        if (col_pins[c] == pin) return true;
+    }
+    return false;
+}
+
+// Tracks when a column stops being held low, by a row or by driving it
+static void column_track(pin_t pin) {
+    host_pin_t *p   = &pins[pin];
+    const bool  low = p->output ? !p->level : column_pulled(pin);
+    if (p->pulled && !low) p->recovered = host_time_us + host_col_recovery_us;
+    p->pulled = low;
+}
+
+static bool pin_level(pin_t pin) {
+    const host_pin_t *p = &pins[pin];
+    if (p->output) return p->level;
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+            if (direct_pins[r][c] == pin) return !host_keys[r][c];
+        }
+    }
+    if (is_column(pin)) {
+        return !column_pulled(pin) && (int32_t)(host_time_us - p->recovered) >= 0;
+    }
+    return true; // pull-up
+}
+
+void host_port_update(void) {
+    for (pin_t pin = 0; pin < PORT_NUM * 16; pin++) {
+        if (is_column(pin)) column_track(pin);
+    }
+    for (pin_t pin = 0; pin < PORT_NUM * 16; pin++) {
+        host_pin_t *p     = &pins[pin];
+        const bool  level = pin_level(pin);
+        const bool  fell  = p->last && !level;
+        p->last           = level;
+        if (fell && p->armed && p->cb) {
+            host_port_callbacks++;
+            p->cb(p->arg);
+        }
+    }
+}
+
+void host_port_reset(void) {
+    memset(pins, 0, sizeof(pins));
+    memset(host_keys, 0, sizeof(host_keys));
+    for (pin_t pin = 0; pin < PORT_NUM * 16; pin++) pins[pin].last = true;
+}
+
+void gpio_set_pin_input(pin_t pin) {
+    pins[pin].output = false;
+    host_port_update();
+}
+void gpio_set_pin_input_high(pin_t pin) {
+    gpio_set_pin_input(pin);
+}
+void gpio_set_pin_output(pin_t pin) {
+    pins[pin].output = true;
+    host_port_update();
+}
+void gpio_set_pin_output_open_drain(pin_t pin) {
+    gpio_set_pin_output(pin);
+}
+void gpio_write_pin_low(pin_t pin) {
+    pins[pin].level = false;
+    host_port_update();
+}
+void gpio_write_pin_high(pin_t pin) {
+    pins[pin].level = true;
+    host_port_update();
+}
+bool gpio_read_pin(pin_t pin) {
+    return pin_level(pin);
+}
+
+ioportmask_t palReadPort(ioportid_t port) {
+    ioportmask_t idr = 0;
+    for (uint8_t pad = 0; pad < 16; pad++) {
+        if (pin_level(port->index * 16 + pad)) idr |= (ioportmask_t)1 << pad;
+    }
+    return idr;
+}
+
+void palEnableLineEvent(pin_t pin, uint32_t mode) {
+    (void)mode;
+    pins[pin].armed = true;
+    pins[pin].last  = pin_level(pin);
+}
+void palDisableLineEvent(pin_t pin) {
+    pins[pin].armed = false;
+}
+void palSetLineCallback(pin_t pin, void (*cb)(void *), void *arg) {
+    pins[pin].cb  = cb;
+    pins[pin].arg = arg;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "quantum.h"
+
+// Ground truth of the simulated keyboard; call host_port_update() after changing it
+extern bool host_keys[MATRIX_ROWS][MATRIX_COLS];
+// Line callbacks fired so far, i.e. EXTI wakes of the idle matrix
+extern uint32_t host_port_callbacks;
+// How long a column keeps reading low after it is released (default 0)
+extern uint32_t host_col_recovery_us;
+
+void host_port_reset(void);
+// Re-evaluates the lines and fires the callbacks of armed lines that fell
+void host_port_update(void);
@@ -0,0 +1,25 @@
+#pragma once
+
+/*
+ * Minimal check helpers for the host tests: a failed CHECK prints where and
+ * why, and the test's main() returns host_test_result() so `make test` stops
+ * on the first failing binary.
+ */
+#include <stdio.h>
+
+static int host_test_failures = 0;
+
+#define CHECK(cond, ...)                                                \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            host_test_failures++;                                       \
+            fprintf(stderr, "%s:%d: check failed: ", __FILE__, __LINE__);\
+            fprintf(stderr, __VA_ARGS__);                               \
+            fputc('\n', stderr);                                        \
+        }                                                               \
+    } while (0)
+
+static inline int host_test_result(const char *name) {
+    printf("%s: %s\n", name, host_test_failures ? "FAIL" : "ok");
+    return host_test_failures ? 1 : 0;
+}
@@ -0,0 +1,197 @@
+/*
+ * Replays trackball edges through the motion pipeline on the host.
+ *
+ *   replay [options] trace.txt
+ *   replay [options] -s rate:count[:y]
+ *
+ * A trace holds edge_record words (edge_record.h), one per line in hex or
+ * decimal, as read out with HID_CMD_EDGE_READ; '#' starts a comment. With -s
+ * a stroke of `count` edges at `rate` edges/s on X (or Y) is synthesized
+ * instead.
+ *
+ * Reports are generated every -r ms like pointing_device_driver_get_report():
+ * edges up to the report time are fed to trackball_move(), then
+ * trackball_motion_report() runs unless the quiescent path skips it. Replay
+ * continues past the last edge until the glide has stopped.
+ *
+ * Output is one line per report that moved, "ms x y h v X Y" with X/Y the
+ * running cursor position, then totals and the host time per call of
+ * trackball_move() and trackball_motion_report(). Host nanoseconds only
+ * compare builds with each other; use PROFILE_ENABLE for MCU cycles.
+ *
+ * Options: -r ms    report interval (default 1)
+ *          -w       wheel mode (Select held)
+ *          -W res   wheel units per detent in wheel mode (default 120)
+ *          -p       precision mode
+ *          -c n     curve: 0 natural, 1 linear, 2 aggressive (default 0)
+ *          -q       totals and timing only
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "trackball_motion.h"
+#include "edge_record.h"
+
+#define MAX_EDGES 100000
+
+typedef struct {
+  uint32_t time;
+  uint8_t axis;
+  int8_t direction;
+  bool dropped;
+} trace_edge_t;
+
+typedef struct {
+  uint64_t calls;
+  uint64_t total_ns;
+  uint64_t max_ns;
+} call_time_t;
+
+static trace_edge_t edges[MAX_EDGES];
+static size_t edge_count = 0;
+
+static uint64_t clock_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void call_time_add(call_time_t* ct, uint64_t ns) {
+  ct->calls++;
+  ct->total_ns += ns;
+  if (ns > ct->max_ns) ct->max_ns = ns;
+}
+
+static void call_time_print(const char* name, const call_time_t* ct) {
+  printf("%-24s %8llu calls, avg %6.1f ns, max %6llu ns\n", name, (unsigned long long)ct->calls,
+         ct->calls ? (double)ct->total_ns / ct->calls : 0.0, (unsigned long long)ct->max_ns);
+}
+
+// Unwraps the 29-bit timestamps by assuming time only moves forward
+static bool load_trace(const char* path) {
+  FILE* f = fopen(path, "r");
+  if (f == NULL) {
+    perror(path);
+    return false;
+  }
+  char line[128];
+  uint32_t last = 0, high = 0;
+  while (fgets(line, sizeof(line), f) != NULL && edge_count < MAX_EDGES) {
+    char* hash = strchr(line, '#');
+    if (hash != NULL) *hash = '\0';
+    char* end;
+    const unsigned long word = strtoul(line, &end, 0);
+    if (end == line) continue;
+
+    const uint32_t stamp = word & EDGE_RECORD_TIME_MASK;
+    if (edge_count > 0 && stamp < last) high += EDGE_RECORD_TIME_MASK + 1;
+    last = stamp;
+    edges[edge_count++] = (trace_edge_t){
+      .time = high + stamp,
+      .axis = (word & EDGE_RECORD_AXIS_Y) ? AXIS_Y : AXIS_X,
+      .direction = (word & EDGE_RECORD_INCR) ? TB_INCR : TB_DECR,
+      .dropped = (word & EDGE_RECORD_DROPPED) != 0,
+    };
+  }
+  fclose(f);
+  return true;
+}
+
+static bool synth_trace(const char* spec) {
+  unsigned rate = 0, count = 0;
+  char axis = 'x';
+  if (sscanf(spec, "%u:%u:%c", &rate, &count, &axis) < 2 || rate == 0 || count > MAX_EDGES) return false;
+  for (unsigned i = 0; i < count; i++) {
+    edges[edge_count++] = (trace_edge_t){
+      .time = 1000000 + (uint32_t)((uint64_t)i * 1000000 / rate),
+      .axis = axis == 'y' ? AXIS_Y : AXIS_X,
+      .direction = TB_INCR,
+    };
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  uint16_t report_ms = 1;
+  uint16_t wheel_resolution = 120;
+  uint8_t mode = MODE_MOUSE;
+  int curve = CURVE_NATURAL;
+  bool quiet = false;
+  const char* synth = NULL;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "r:wW:pc:qs:")) != -1) {
+    switch (opt) {
+      case 'r': report_ms = (uint16_t)atoi(optarg); break;
+      case 'w': mode = MODE_WHEEL; break;
+      case 'W': wheel_resolution = (uint16_t)atoi(optarg); break;
+      case 'p': precision_mode = true; break;
+      case 'c': curve = atoi(optarg); break;
+      case 'q': quiet = true; break;
+      case 's': synth = optarg; break;
+      default: return 2;
+    }
+  }
+  const bool loaded = synth ? synth_trace(synth) : (optind < argc && load_trace(argv[optind]));
+  if (!loaded || edge_count == 0 || report_ms == 0) {
+    fprintf(stderr, "usage: %s [-r ms] [-w] [-W res] [-p] [-c curve] [-q] (trace.txt | -s rate:count[:y])\n", argv[0]);
+    return 2;
+  }
+
+  uint8_t count;
+  const curve_point_t* points = curve_builtin((curve_profile_t)curve, &count);
+  if (points == NULL || !trackball_motion_set_curve(points, count)) {
+    fprintf(stderr, "unknown curve %d\n", curve);
+    return 2;
+  }
+  trackball_motion_set_wheel_resolution(wheel_resolution);
+  trackball_motion_report(mode, report_ms);
+
+  call_time_t move_time = {0}, report_time = {0};
+  long pos_x = 0, pos_y = 0, wheel_h = 0, wheel_v = 0;
+  size_t next = 0, dropped = 0, agree = 0;
+  uint32_t skipped = 0;
+  const uint32_t start_ms = edges[0].time / 1000;
+
+  for (uint32_t ms = start_ms;; ms += report_ms) {
+    const uint32_t report_us = (ms + 1) * 1000;
+    bool moved = false;
+    while (next < edge_count && edges[next].time < report_us) {
+      const trace_edge_t* e = &edges[next++];
+      const uint64_t t0 = clock_ns();
+      const bool accepted = trackball_move(e->axis, e->direction, e->time);
+      call_time_add(&move_time, clock_ns() - t0);
+      if (!accepted) dropped++;
+      if (accepted != e->dropped) agree++;
+      moved = true;
+    }
+
+    if (!moved && trackball_motion_idle(mode, report_ms)) {
+      skipped++;
+      if (next == edge_count) break;
+      continue;
+    }
+    // A glide cannot outlast the longest release by this much
+    if (next == edge_count && ms > edges[edge_count - 1].time / 1000 + 120000) break;
+    const uint64_t t0 = clock_ns();
+    const trackball_motion_t m = trackball_motion_report(mode, report_ms);
+    call_time_add(&report_time, clock_ns() - t0);
+
+    pos_x += m.x;
+    pos_y += m.y;
+    wheel_h += m.h;
+    wheel_v += m.v;
+    if (!quiet && (m.x || m.y || m.h || m.v)) {
+      printf("%u %d %d %d %d %ld %ld\n", ms - start_ms, m.x, m.y, m.h, m.v, pos_x, pos_y);
+    }
+  }
+
+  printf("edges %zu, dropped by the filter %zu", edge_count, dropped);
+  if (!synth) printf(" (same decision as the capture: %zu)", agree);
+  printf("\ncursor %ld %ld, wheel %ld %ld, quiescent reports skipped %u\n", pos_x, pos_y, wheel_h, wheel_v, skipped);
+  call_time_print("trackball_move", &move_time);
+  call_time_print("trackball_motion_report", &report_time);
+  return 0;
+}
@@ -0,0 +1,5 @@
+#pragma once
+#include "quantum.h"
+
+void debounce_init(void);
+bool debounce(matrix_row_t raw[], matrix_row_t cooked[], bool changed);
@@ -0,0 +1,99 @@
+#pragma once
+
+/*
+ * Just enough of QMK and ChibiOS for the matrix and debounce sources to build
+ * on the host. Pins map onto the simulated GPIO ports of host_port.c, and time
+ * is the simulated clock there; nothing here runs on its own.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+
+#ifndef MIN
+#    define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+#    define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+#define uprintf printf
+
+/* Time: host_time_us advances only through host_advance_us() and wait_us() */
+extern uint32_t host_time_us;
+void host_advance_us(uint32_t us);
+
+#define TIMER_DIFF_16(a, b) ((uint16_t)((a) - (b)))
+static inline uint16_t timer_read(void) {
+    return (uint16_t)(host_time_us / 1000);
+}
+static inline uint16_t timer_elapsed(uint16_t last) {
+    return TIMER_DIFF_16(timer_read(), last);
+}
+static inline void wait_us(uint32_t us) {
+    host_advance_us(us);
+}
+
+/* Matrix shape and pins, as in keyboard.json */
+#define MATRIX_ROWS 11
+#define MATRIX_COLS 8
+typedef uint8_t matrix_row_t;
+
+#define COL2ROW 0
+#define ROW2COL 1
+#define DIODE_DIRECTION COL2ROW
+
+/* A pin is port * 16 + pad; ports 0..2 are GPIOA..GPIOC */
+typedef uint32_t pin_t;
+typedef struct {
+    uint8_t index;
+} host_gpio_t;
+typedef host_gpio_t *ioportid_t;
+typedef uint32_t ioportmask_t;
+extern host_gpio_t host_gpio[];
+#define NO_PIN 0xFFFFFFFFu
+#define PAL_PORT(p) (&host_gpio[(p) >> 4])
+#define PAL_PAD(p) ((p) & 15)
+#define A0 0
+#define A1 1
+#define A2 2
+#define A3 3
+#define A4 4
+#define A5 5
+#define A6 6
+#define A7 7
+#define B(n) (16 + (n))
+#define C(n) (32 + (n))
+
+#define MATRIX_ROW_PINS {NO_PIN, NO_PIN, NO_PIN, A0, A1, A2, A3, A4, A5, A6, A7}
+#define MATRIX_COL_PINS {C(0), C(1), C(2), C(3), C(4), C(5), C(6), C(7)}
+#define DIRECT_PINS                                                           \
+    {                                                                         \
+        {B(0), B(1), B(2), B(3), B(4), B(5), B(6), B(7)},                     \
+        {B(8), B(9), B(10), B(11), B(12), B(13), B(14), B(15)},               \
+        {C(12), NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN},      \
+        {NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN},     \
+        {NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN},     \
+        {NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN},     \
+        {NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN},     \
+        {NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN},     \
+        {NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN},     \
+        {NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN},     \
+        {NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN, NO_PIN},     \
+    }
+
+void gpio_set_pin_input(pin_t pin);
+void gpio_set_pin_input_high(pin_t pin);
+void gpio_set_pin_output(pin_t pin);
+void gpio_set_pin_output_open_drain(pin_t pin);
+void gpio_write_pin_low(pin_t pin);
+void gpio_write_pin_high(pin_t pin);
+bool gpio_read_pin(pin_t pin);
+ioportmask_t palReadPort(ioportid_t port);
+
+#define PAL_USE_CALLBACKS 1
+#define PAL_EVENT_MODE_FALLING_EDGE 1
+void palEnableLineEvent(pin_t pin, uint32_t mode);
+void palDisableLineEvent(pin_t pin);
+void palSetLineCallback(pin_t pin, void (*cb)(void *), void *arg);
@@ -0,0 +1,17 @@
+#pragma once
+
+/* Just the USB state sof_sync.c reads: the frame number register and the driver state */
+#include <stdint.h>
+
+typedef struct {
+    volatile uint32_t FNR;
+} host_usb_t;
+extern host_usb_t host_usb;
+#define USB (&host_usb)
+#define USB_FNR_FN 0x07FFu
+
+typedef enum { USB_STOP, USB_READY, USB_SELECTED, USB_ACTIVE, USB_SUSPENDED } usbstate_t;
+typedef struct {
+    usbstate_t state;
+} host_usb_driver_t;
+extern host_usb_driver_t USB_DRIVER;
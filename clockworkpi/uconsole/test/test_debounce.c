@@ -0,0 +1,97 @@
+/*
+ * debounce_vertical.c against a per-key reference of the same rule: a press
+ * is reported on the scan that first reads it, a release once the key has
+ * read released for DEBOUNCE ms. Both see the same random raw matrices at
+ * random scan intervals, and their cooked matrices must match after every
+ * scan. Built once per DEBOUNCE value (see the Makefile).
+ */
+#include <stdlib.h>
+#include "host_test.h"
+#include "quantum.h"
+#include "debounce.h"
+
+#define SCANS 300000
+
+typedef struct {
+    bool     pressed;   // cooked state
+    bool     releasing; // pressed but reading released
+    uint16_t since;     // timer_read() of the scan the release started on
+} ref_key_t;
+
+static ref_key_t ref[MATRIX_ROWS][MATRIX_COLS];
+
+static void ref_debounce(const matrix_row_t raw[], matrix_row_t cooked[]) {
+    const uint16_t now = timer_read();
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        cooked[r] = 0;
+        for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+            ref_key_t *k = &ref[r][c];
+            if (raw[r] >> c & 1) {
+                k->pressed   = true;
+                k->releasing = false;
+            } else if (k->pressed) {
+                if (!k->releasing) {
+                    k->releasing = true;
+                    k->since     = now;
+                } else if (TIMER_DIFF_16(now, k->since) >= DEBOUNCE) {
+                    k->pressed   = false;
+                    k->releasing = false;
+                }
+            }
+            if (k->pressed) cooked[r] |= (matrix_row_t)1 << c;
+        }
+    }
+}
+
+// Mostly short steps, sometimes a stall longer than the window
+static uint32_t random_step_us(void) {
+    const int pick = rand() % 100;
+    if (pick < 80) return 200 + rand() % 1500;
+    if (pick < 97) return rand() % (DEBOUNCE * 1000 + 1000);
+    return rand() % 50000;
+}
+
+int main(void) {
+    static matrix_row_t held[MATRIX_ROWS], raw[MATRIX_ROWS], prev[MATRIX_ROWS];
+    static matrix_row_t cooked[MATRIX_ROWS], expected[MATRIX_ROWS], last_expected[MATRIX_ROWS];
+    srand(DEBOUNCE);
+    debounce_init();
+
+    uint32_t mismatches = 0, changes = 0;
+    for (uint32_t scan = 0; scan < SCANS; scan++) {
+        host_advance_us(random_step_us());
+
+        // Keys toggle now and then and chatter around each toggle
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+                if (rand() % 400 == 0) held[r] ^= (matrix_row_t)1 << c;
+            }
+            const matrix_row_t chatter = rand() % 4 == 0 ? (matrix_row_t)rand() : 0;
+            raw[r] = held[r] ^ (chatter & (matrix_row_t)rand());
+        }
+
+        bool changed = false;
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            if (raw[r] != prev[r]) changed = true;
+            prev[r] = raw[r];
+        }
+
+        const bool cooked_changed = debounce(raw, cooked, changed);
+        ref_debounce(raw, expected);
+
+        bool differs = false, expected_change = false;
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            if (cooked[r] != expected[r]) differs = true;
+            if (expected[r] != last_expected[r]) expected_change = true;
+            last_expected[r] = expected[r];
+        }
+        if (differs && mismatches++ < 5) {
+            CHECK(false, "scan %u: cooked differs from the reference", scan);
+        }
+        CHECK(cooked_changed == expected_change, "scan %u: change flag %d", scan, cooked_changed);
+        if (expected_change) changes++;
+    }
+    CHECK(mismatches == 0, "%u of %u scans differ", mismatches, SCANS);
+    CHECK(changes > SCANS / 20, "only %u cooked changes", changes);
+    return host_test_result(TEST_NAME);
+}
@@ -0,0 +1,118 @@
+/*
+ * debounce_adaptive.c on one key scanned every millisecond. A release is
+ * reported one window after the key first reads released, so the window is
+ * read back from the release delay: chatter must widen it by
+ * DEBOUNCE_ADAPT_GROW_MS up to the maximum, a bounce absorbed by the window
+ * must restart the clean count, and clean presses must bring it back down to
+ * the floor and no further.
+ */
+#include "host_test.h"
+#include "quantum.h"
+#include "debounce.h"
+#include "debounce_adaptive.h"
+
+#define KEY_ROW 4
+#define KEY_COL 3
+#define HOLD_MS 20
+#define QUIET_MS (DEBOUNCE_ADAPT_CHATTER_MS + 10) // a gap after a release that is not chatter
+#define CHATTER_MS (DEBOUNCE_ADAPT_CHATTER_MS / 2)
+
+static matrix_row_t raw[MATRIX_ROWS], cooked[MATRIX_ROWS];
+static bool         raw_on;
+
+static bool scan(bool on) {
+    const bool changed = on != raw_on;
+    raw_on             = on;
+    raw[KEY_ROW]       = on ? (matrix_row_t)1 << KEY_COL : 0;
+    host_advance_us(1000);
+    debounce(raw, cooked, changed);
+    return cooked[KEY_ROW] >> KEY_COL & 1;
+}
+
+static void hold(bool on, uint16_t ms) {
+    while (ms--) scan(on);
+}
+
+// Lets go of the key; returns how many scans still reported it pressed
+static uint16_t release(void) {
+    uint16_t ms = 0;
+    while (scan(false) && ms <= 2 * DEBOUNCE_ADAPT_MAX_MS) ms++;
+    return ms;
+}
+
+// A clean press after a quiet gap; returns its release delay
+static uint16_t clean_press(void) {
+    hold(false, QUIET_MS);
+    CHECK(scan(true), "press not reported on its first scan");
+    hold(true, HOLD_MS);
+    return release();
+}
+
+static uint8_t window_expected(int16_t ms) {
+    return ms < DEBOUNCE_ADAPT_MIN_MS ? DEBOUNCE_ADAPT_MIN_MS : ms > DEBOUNCE_ADAPT_MAX_MS ? DEBOUNCE_ADAPT_MAX_MS : ms;
+}
+
+static void check_chatter_widens(void) {
+    uint16_t window = clean_press();
+    CHECK(window == window_expected(DEBOUNCE), "initial window %u ms", window);
+
+    // Each press CHATTER_MS after a reported release grows the window, up to the maximum
+    for (int i = 0; i < DEBOUNCE_ADAPT_MAX_MS / DEBOUNCE_ADAPT_GROW_MS + 2; i++) {
+        clean_press();
+        hold(false, CHATTER_MS);
+        hold(true, HOLD_MS);
+        const uint16_t grown = release();
+        CHECK(grown == window_expected(window + DEBOUNCE_ADAPT_GROW_MS), "chatter %d: window %u ms after %u ms", i, grown, window);
+        window = grown;
+    }
+    CHECK(window == DEBOUNCE_ADAPT_MAX_MS, "window %u ms after repeated chatter", window);
+}
+
+// Entered with the window at the maximum and one clean release since the last chatter
+static void check_bounce_restarts_count(void) {
+    for (int i = 0; i < DEBOUNCE_ADAPT_CLEAN_PRESSES - 2; i++) clean_press();
+
+    // Released for less than the window and back: absorbed, and the count starts over
+    hold(false, QUIET_MS);
+    hold(true, HOLD_MS);
+    CHECK(scan(false) && scan(false), "release reported inside the window");
+    CHECK(scan(true), "bounce reached the host");
+    hold(true, HOLD_MS);
+    CHECK(release() == DEBOUNCE_ADAPT_MAX_MS, "bounced release");
+
+    for (int i = 0; i < DEBOUNCE_ADAPT_CLEAN_PRESSES - 1; i++) {
+        const uint16_t window = clean_press();
+        CHECK(window == DEBOUNCE_ADAPT_MAX_MS, "window %u ms after %d clean presses past a bounce", window, i + 1);
+    }
+    clean_press();
+    CHECK(clean_press() == DEBOUNCE_ADAPT_MAX_MS - 1, "window did not shrink after a clean run");
+}
+
+static void check_decay_to_floor(void) {
+    uint16_t window  = DEBOUNCE_ADAPT_MAX_MS - 1;
+    uint32_t presses = 0;
+    while (window > DEBOUNCE_ADAPT_MIN_MS && presses < 2 * DEBOUNCE_ADAPT_MAX_MS * DEBOUNCE_ADAPT_CLEAN_PRESSES) {
+        const uint16_t next = clean_press();
+        CHECK(next == window || next + 1 == window, "window went from %u to %u ms", window, next);
+        window = next;
+        presses++;
+    }
+    CHECK(window == DEBOUNCE_ADAPT_MIN_MS, "window %u ms after %u clean presses", window, presses);
+    const uint32_t steps = DEBOUNCE_ADAPT_MAX_MS - 1 - DEBOUNCE_ADAPT_MIN_MS;
+    CHECK(presses > (steps - 1) * DEBOUNCE_ADAPT_CLEAN_PRESSES && presses <= steps * DEBOUNCE_ADAPT_CLEAN_PRESSES + 1,
+          "%u clean presses to decay %u ms", presses, steps);
+
+    for (int i = 0; i < 2 * DEBOUNCE_ADAPT_CLEAN_PRESSES; i++) {
+        window = clean_press();
+        if (window != DEBOUNCE_ADAPT_MIN_MS) break;
+    }
+    CHECK(window == DEBOUNCE_ADAPT_MIN_MS, "window left the floor: %u ms", window);
+}
+
+int main(void) {
+    debounce_init();
+    check_chatter_widens();
+    check_bounce_restarts_count();
+    check_decay_to_floor();
+    return host_test_result("test_debounce_adaptive");
+}
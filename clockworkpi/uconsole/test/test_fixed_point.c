@@ -0,0 +1,91 @@
+/*
+ * Q16.16 primitives and the velocity curve against double precision: the
+ * tolerances quoted in fixed_point.h and trackball_curve.h.
+ */
+#include <math.h>
+#include <stdlib.h>
+#include "host_test.h"
+#include "fixed_point.h"
+#include "trackball_curve.h"
+
+static double to_d(fix16_t x) {
+    return x / 65536.0;
+}
+
+static fix16_t random_fix16(int32_t range) {
+    return (fix16_t)((((int64_t)rand() << 16) ^ rand()) % ((int64_t)range << FIX16_SHIFT));
+}
+
+static void check_arithmetic(void) {
+    for (int i = 0; i < 200000; i++) {
+        const fix16_t a = random_fix16(180), b = random_fix16(180);
+        const double mul = to_d(a) * to_d(b);
+        CHECK(fabs(to_d(fix16_mul(a, b)) - mul) <= 1.0 / 65536, "fix16_mul(%d, %d)", a, b);
+        if (b > FIX16_ONE / 16) {
+            const double div = to_d(a) / to_d(b);
+            CHECK(fabs(to_d(fix16_div(a, b)) - div) <= 1.0 / 65536, "fix16_div(%d, %d)", a, b);
+        }
+    }
+}
+
+static void check_roots(void) {
+    for (int i = 0; i < 200000; i++) {
+        const fix16_t a = abs(random_fix16(4000)), b = abs(random_fix16(4000));
+        CHECK(fabs(to_d(fix16_sqrt(a)) - sqrt(to_d(a))) <= 1.0 / 65536, "fix16_sqrt(%d)", a);
+        CHECK(fabs(to_d(fix16_hypot(a, b)) - hypot(to_d(a), to_d(b))) <= 1.0 / 65536, "fix16_hypot(%d, %d)", a, b);
+    }
+    for (uint32_t x = 0; x < 2000000; x += 7) {
+        CHECK(isqrt32(x) == (uint32_t)sqrt((double)x), "isqrt32(%u)", x);
+    }
+}
+
+static void check_exp2(void) {
+    double worst = 0;
+    for (fix16_t x = 0; x < (17 << FIX16_SHIFT); x++) {
+        const double ref = 65536.0 * pow(2.0, -to_d(x));
+        const double got = fix16_exp2_neg(x);
+        // Relative bound where the result has the bits for it, a few LSB below
+        if (ref >= 8192) {
+            worst = fmax(worst, fabs(got - ref) / ref);
+        } else {
+            CHECK(fabs(got - ref) <= 6, "fix16_exp2_neg(%d) = %.0f, want %.1f", x, got, ref);
+        }
+    }
+    CHECK(worst < 1.0 / 8192, "fix16_exp2_neg relative error %.2e", worst);
+    CHECK(fix16_exp2_neg(-FIX16_ONE) == FIX16_ONE, "2^-x for x < 0");
+    CHECK(fix16_exp2_neg(INT32_MAX) == 0, "2^-x for large x");
+}
+
+static void check_curve(void) {
+    curve_t curve;
+    uint8_t count;
+    const curve_point_t *natural = curve_builtin(CURVE_NATURAL, &count);
+    CHECK(curve_load(&curve, natural, count), "natural table loads");
+
+    double worst = 0;
+    for (double x = 0.03; x < 4000; x *= 1.01) {
+        const double ref = 0.1 + (x - 0.02) / 20 + pow(x - 0.02, 1.5) / 40;
+        worst = fmax(worst, fabs(to_d(curve_eval(&curve, (fix16_t)(x * 65536))) - ref) / ref);
+    }
+    CHECK(worst < 0.03, "natural curve off the closed form by %.1f%%", worst * 100);
+    CHECK(curve_eval(&curve, FIX16_CONST(0.01)) == 0, "deadzone");
+
+    // Custom tables need not be monotonic; a steep drop must saturate, not wrap
+    const curve_point_t cliff[] = {
+        {0, CURVE_MAX_Y}, {1, 0}, {2, 0}, {3, CURVE_MAX_Y}, {4, CURVE_MAX_Y},
+    };
+    CHECK(curve_load(&curve, cliff, 5), "steep table loads");
+    CHECK(curve.slopes[0] == INT32_MIN && curve.slopes[2] == INT32_MAX,
+          "steep slopes saturate (%d, %d)", curve.slopes[0], curve.slopes[2]);
+    CHECK(curve_eval(&curve, 0) == CURVE_MAX_Y && curve_eval(&curve, 1) == 0, "falling segment");
+    CHECK(curve_eval(&curve, 3) == CURVE_MAX_Y && curve_eval(&curve, 4) == CURVE_MAX_Y, "rising segment");
+}
+
+int main(void) {
+    srand(1);
+    check_arithmetic();
+    check_roots();
+    check_exp2();
+    check_curve();
+    return host_test_result("test_fixed_point");
+}
@@ -0,0 +1,109 @@
+/*
+ * matrix.c against the simulated ports: every scan must return exactly the
+ * keys held at that moment. The Makefile builds this with bulk reads and idle
+ * mode (the firmware default), with MATRIX_NO_BULK_READ and with
+ * MATRIX_IDLE_TIMEOUT=0, so the three scan paths agree with each other.
+ *
+ * The columns take HOST_COL_RECOVERY_US to recover from a released row, so
+ * the calibrated settle wait must cover that or the previous row ghosts in.
+ * matrix_idle_armed() must never claim the idle mode is armed while a matrix
+ * key is down, or STOP would sleep through it.
+ */
+#include <stdlib.h>
+#include "host_test.h"
+#include "host_port.h"
+#include "matrix_settle.h"
+#include "matrix_idle.h"
+
+#define HOST_COL_RECOVERY_US 3
+
+void matrix_init_custom(void);
+bool matrix_scan_custom(matrix_row_t current_matrix[]);
+
+static const pin_t row_pins[MATRIX_ROWS] = MATRIX_ROW_PINS;
+static const pin_t direct_pins[MATRIX_ROWS][MATRIX_COLS] = DIRECT_PINS;
+
+static bool key_exists(uint8_t r, uint8_t c) {
+    return direct_pins[r][c] != NO_PIN || row_pins[r] != NO_PIN;
+}
+
+// A key on the row/column matrix, which only the idle mode's edges can see
+static bool matrix_key_held(void) {
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+            if (row_pins[r] != NO_PIN && host_keys[r][c]) return true;
+        }
+    }
+    return false;
+}
+
+static void random_key(uint8_t *r, uint8_t *c) {
+    do {
+        *r = rand() % MATRIX_ROWS;
+        *c = rand() % MATRIX_COLS;
+    } while (!key_exists(*r, *c));
+}
+
+int main(void) {
+    srand(7);
+    host_port_reset();
+    host_col_recovery_us = HOST_COL_RECOVERY_US;
+    matrix_init_custom();
+    CHECK(matrix_settle_time() > HOST_COL_RECOVERY_US && matrix_settle_time() < 30,
+          "settle %u us not calibrated to the %u us recovery", matrix_settle_time(), HOST_COL_RECOVERY_US);
+
+    matrix_row_t current[MATRIX_ROWS];
+    uint32_t     scans = 0, mismatches = 0, armed = 0, armed_held = 0;
+
+    for (int step = 0; step < 300000; step++) {
+        // Mostly quiet stretches (long enough to enter idle mode) broken up by
+        // typing bursts with rollover, and the odd very short tap between scans
+        const int phase = (step / 2000) % 4;
+        if (phase != 0 && rand() % 8 == 0) {
+            uint8_t r, c;
+            random_key(&r, &c);
+            host_keys[r][c] = !host_keys[r][c];
+        } else if (phase == 0) {
+            memset(host_keys, 0, sizeof(host_keys));
+            if (rand() % 500 == 0) {
+                uint8_t r, c;
+                random_key(&r, &c);
+                host_keys[r][c] = true;
+                host_port_update();
+                host_advance_us(100);
+                host_keys[r][c] = false;
+            }
+        }
+        host_port_update();
+        host_advance_us(200 + rand() % 1000);
+
+        if (matrix_idle_armed()) {
+            armed++;
+            if (matrix_key_held()) armed_held++;
+        }
+
+        memset(current, 0, sizeof(current));
+        matrix_scan_custom(current);
+        scans++;
+
+        bool ok = true;
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            matrix_row_t want = 0;
+            for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+                if (host_keys[r][c]) want |= (matrix_row_t)1 << c;
+            }
+            if (current[r] != want) ok = false;
+        }
+        if (!ok) mismatches++;
+    }
+    CHECK(mismatches == 0, "%u of %u scans differ from the held keys", mismatches, scans);
+    CHECK(armed_held == 0, "idle reported armed with a matrix key down on %u scans", armed_held);
+#if !defined(MATRIX_IDLE_TIMEOUT) || MATRIX_IDLE_TIMEOUT > 0
+    CHECK(host_port_callbacks > 0, "idle mode was never woken by a column edge");
+    CHECK(armed > 0, "idle mode was never armed");
+#else
+    CHECK(armed == 0, "idle reported armed with the idle mode disabled");
+#endif
+    matrix_settle_print();
+    return host_test_result(TEST_NAME);
+}
@@ -0,0 +1,162 @@
+/*
+ * Motion pipeline checks on synthetic edge streams: tuning validation, the
+ * rate meter's steady state, the quiescent fast path and frame-rate
+ * independence of the glide.
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_test.h"
+#include "trackball_motion.h"
+#include "glider.h"
+#include "rate_meter.h"
+
+static uint32_t now_us = 1000000;
+
+// Switching modes clears all motion state; a pause past idle_reset_ms clears
+// the rebound filter on the next edge
+static void motion_reset(void) {
+    trackball_motion_report(MODE_WHEEL, 1);
+    trackball_motion_report(MODE_MOUSE, 1);
+    now_us += 10000000;
+}
+
+static void check_tuning(void) {
+    const trackball_tuning_t defaults = TRACKBALL_TUNING_DEFAULTS;
+    CHECK(memcmp(trackball_motion_get_tuning(), &defaults, sizeof(defaults)) == 0, "defaults in effect");
+
+    trackball_tuning_t t = defaults;
+    t.wheel_denom = 0;
+    CHECK(!trackball_motion_set_tuning(&t), "zero wheel_denom accepted");
+    t = defaults;
+    t.idle_reset_ms = 0;
+    CHECK(!trackball_motion_set_tuning(&t), "zero idle_reset_ms accepted");
+    t = defaults;
+    t.precision_scale = 0;
+    CHECK(!trackball_motion_set_tuning(&t), "zero precision_scale accepted");
+    CHECK(memcmp(trackball_motion_get_tuning(), &defaults, sizeof(defaults)) == 0, "rejected tuning applied");
+
+    t = defaults;
+    t.wheel_denom = 12;
+    CHECK(trackball_motion_set_tuning(&t), "valid tuning rejected");
+    CHECK(trackball_motion_get_tuning()->wheel_denom == 12, "tuning not applied");
+    CHECK(trackball_motion_set_tuning(&defaults), "defaults rejected");
+}
+
+// Random strokes with pauses; `fast` takes the quiescent path like the driver
+static unsigned long run_strokes(bool fast, unsigned long *skipped) {
+    unsigned long hash = 0;
+    srand(5);
+    motion_reset();
+    for (int r = 0; r < 200000; r++) {
+        const uint8_t mode = (r / 30000) % 2 ? MODE_WHEEL : MODE_MOUSE;
+        precision_mode     = (r / 70000) % 2;
+        const int edges    = (r / 500) % 3 == 0 ? rand() % 4 : 0;
+        for (int e = 0; e < edges; e++) {
+            now_us += 200 + rand() % 3000;
+            trackball_move(rand() % 5 == 0 ? AXIS_Y : AXIS_X, rand() % 9 == 0 ? TB_DECR : TB_INCR, now_us);
+        }
+        const uint16_t delta = 1 + rand() % 3;
+        now_us += delta * 1000;
+
+        trackball_motion_t m = {0};
+        if (!fast || edges || !trackball_motion_idle(mode, delta)) {
+            m = trackball_motion_report(mode, delta);
+        } else {
+            (*skipped)++;
+        }
+        hash = hash * 31 + (uint8_t)m.x * 7 + (uint8_t)m.y * 13 + (uint16_t)m.h * 17 + (uint16_t)m.v;
+    }
+    precision_mode = false;
+    return hash;
+}
+
+// At a steady edge rate the meter must report what the EWMA meter settled at
+// (a quarter of the rate, four times the interval), which the curve is tuned for
+static void check_rate_meter(void) {
+    static const uint32_t intervals_us[] = {300, 1000, 5000, 20000, 100000};
+    for (size_t i = 0; i < sizeof(intervals_us) / sizeof(intervals_us[0]); i++) {
+        const uint32_t d = intervals_us[i];
+        rate_meter_t rm = {0};
+        rate_meter_expire(&rm);
+        uint32_t t = 0, ticked = 0;
+        for (int edge = 0; edge < 40; edge++) {
+            t += d;
+            for (; ticked + 1000 <= t; ticked += 1000) rate_meter_tick(&rm, 1);
+            rate_meter_interrupt(&rm, t);
+        }
+        const double rate = rate_meter_rate(&rm, t) / 65536.0, ref = 1e6 / d / 4;
+        CHECK(fabs(rate - ref) < ref / 100, "rate %.2f at %u us, expected %.2f", rate, d, ref);
+        const uint32_t delta = rate_meter_delta(&rm);
+        CHECK(fabs((double)delta - 4.0 * d) <= 4.0 * d / 100 + 1,
+              "delta %u us at %u us", delta, d);
+    }
+}
+
+static void check_idle_path(void) {
+    unsigned long skipped = 0;
+    const unsigned long full = run_strokes(false, &skipped);
+    const unsigned long fast = run_strokes(true, &skipped);
+    CHECK(full == fast, "quiescent fast path changes the output");
+    CHECK(skipped > 0, "fast path never taken");
+}
+
+// Counts reported after `total` ms of glide, in reports of `step` ms
+static long glide(int step, fix16_t speed, uint16_t sustain, uint16_t release, int total, bool rebase) {
+    glider_t g = {0};
+    glider_set_direction(&g, 1);
+    glider_update(&g, speed, sustain, release);
+    long pos = 0;
+    for (int t = 0; t < total; t += step) {
+        if (rebase && t == 40) glider_update_speed(&g, speed / 2);
+        pos += glider_glide(&g, step);
+    }
+    return pos;
+}
+
+static void check_glide(void) {
+    for (int v = 1; v < 60; v += 7) {
+        const fix16_t speed = FIX16_CONST(0.05) * v;
+        for (uint16_t sustain = 0; sustain < 20; sustain += 6) {
+            for (uint16_t release = 0; release < 400; release += 53) {
+                for (int total = 8; total <= 800; total += 8) {
+                    for (int rebase = 0; rebase < 2; rebase++) {
+                        const long p1 = glide(1, speed, sustain, release, total, rebase);
+                        const long p4 = glide(4, speed, sustain, release, total, rebase);
+                        const long p8 = glide(8, speed, sustain, release, total, rebase);
+                        CHECK(p1 == p4 && p1 == p8, "glide depends on the report rate: %ld/%ld/%ld (v=%d s=%u r=%u t=%d)", p1, p4, p8, v, sustain, release, total);
+                    }
+                }
+            }
+        }
+    }
+
+    // Closed form: sustain at full speed, then v * tau * (1 - 2^-(t / half-life))
+    // with tau = release / 2, cut after GLIDER_DECAY_HALVINGS half-lives
+    for (int v = 1; v < 60; v += 3) {
+        for (uint16_t release = 1; release < 400; release += 13) {
+            const double speed = FIX16_CONST(0.05) * v / 65536.0;
+            const double tau = release / 2.0, half_life = tau * log(2.0);
+            const double cutoff = floor(GLIDER_DECAY_HALVINGS * half_life);
+            for (int total = 0; total <= 1200; total += 50) {
+                double ref = speed * fmin(total, 5);
+                const double t = fmin(fmax(total - 5, 0), cutoff);
+                ref += speed * tau * (1 - pow(2.0, -t / half_life));
+                const long got = glide(1, FIX16_CONST(0.05) * v, 5, release, total, false);
+                CHECK(fabs(got - ref) < 2, "glide %ld counts, reference %.2f (v=%d r=%u t=%d)", got, ref, v, release, total);
+            }
+        }
+    }
+}
+
+int main(void) {
+    uint8_t count;
+    const curve_point_t *natural = curve_builtin(CURVE_NATURAL, &count);
+    trackball_motion_set_curve(natural, count);
+
+    check_tuning();
+    check_rate_meter();
+    check_idle_path();
+    check_glide();
+    return host_test_result("test_motion");
+}
@@ -0,0 +1,103 @@
+/*
+ * USB frame alignment against a simulated host: SOFs on a clock 500 ppm off
+ * the MCU's, a main loop with random pass times and the odd long pass. Every
+ * frame must get exactly one scan in the slot before its end, without the
+ * loop ever waiting in sof_sync_due().
+ */
+#include <stdlib.h>
+#include "host_test.h"
+#include "quantum.h"
+#include "usb_main.h"
+#include "sof_sync.h"
+
+#define FRAMES 100000
+#define PERIOD_NS 1000500 // host frame length in MCU nanoseconds
+#define PHASE_NS 123456   // start of frame 0
+#define SCAN_US 250       // a full matrix scan
+#define MAX_PASS_US 120   // a main loop pass without a scan
+#define LONG_PASS_US 1500
+#define PHASE_SLACK_US 50 // allowed error of the frame edge estimate
+
+host_usb_t        host_usb;
+host_usb_driver_t USB_DRIVER = {USB_ACTIVE};
+
+static int64_t frame_at(uint32_t t) {
+    return ((int64_t)t * 1000 - PHASE_NS) / PERIOD_NS;
+}
+
+static int64_t frame_start_us(int64_t frame) {
+    return (frame * PERIOD_NS + PHASE_NS) / 1000;
+}
+
+static bool due(void) {
+    host_usb.FNR = (uint32_t)frame_at(host_time_us) & USB_FNR_FN;
+    return sof_sync_due();
+}
+
+static void check_alignment(void) {
+    static uint8_t scans[FRAMES];
+    const int64_t  slot        = 1000 - SOF_SYNC_LEAD_US;
+    uint32_t       long_passes = 0, early = 0, late = 0, mismatched = 0;
+
+    host_time_us = 1000;
+    while (frame_at(host_time_us) < FRAMES) {
+        uint32_t pass = 10 + rand() % (MAX_PASS_US - 10);
+        if (rand() % 2000 == 0) {
+            pass = LONG_PASS_US;
+            long_passes++;
+        }
+        const bool scan = due();
+        if (sof_sync_slot() != scan) mismatched++;
+        if (scan) {
+            const int64_t frame  = frame_at(host_time_us);
+            const int64_t offset = host_time_us - frame_start_us(frame);
+            scans[frame]++;
+            if (frame >= 10) {
+                // The slot opens SOF_SYNC_LEAD_US before the frame ends; the
+                // scan starts on the first pass after it
+                if (offset < slot - PHASE_SLACK_US) early++;
+                if (offset > slot + MAX_PASS_US + PHASE_SLACK_US) late++;
+            }
+            pass += SCAN_US;
+        }
+        host_advance_us(pass);
+    }
+
+    uint32_t twice = 0, missed = 0;
+    for (int64_t f = 10; f < FRAMES; f++) {
+        if (scans[f] > 1) twice++;
+        if (scans[f] == 0) missed++;
+    }
+    CHECK(mismatched == 0, "%u passes where the pointing slot disagrees with the scan", mismatched);
+    CHECK(twice == 0, "%u frames scanned more than once", twice);
+    CHECK(missed <= 2 * long_passes, "%u frames without a scan, %u long passes", missed, long_passes);
+    CHECK(early == 0, "%u scans before the slot", early);
+    CHECK(late <= 3 * long_passes, "%u scans past the slot, %u long passes", late, long_passes);
+}
+
+static void check_no_sof(void) {
+    // Suspended bus: every pass scans
+    USB_DRIVER.state = USB_SUSPENDED;
+    for (int i = 0; i < 100; i++, host_advance_us(50)) {
+        CHECK(due(), "scan skipped while suspended");
+    }
+
+    // Active, but the frame number stopped: scans resume within two frames
+    USB_DRIVER.state = USB_ACTIVE;
+    host_time_us      = 1000;
+    for (int i = 0; i < 100; i++, host_advance_us(50)) due();
+    const uint32_t frame = host_usb.FNR;
+    int skipped = 0;
+    for (int i = 0; i < 200; i++, host_advance_us(50)) {
+        host_usb.FNR = frame;
+        if (!sof_sync_due()) skipped++;
+    }
+    CHECK(skipped <= 2 * 1000 / 50, "%d passes skipped without SOFs", skipped);
+}
+
+int main(void) {
+    srand(1);
+    check_alignment();
+    check_no_sof();
+    return host_test_result("test_sof_sync");
+}
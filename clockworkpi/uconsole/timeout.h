@@ -1,5 +1,6 @@
 #pragma once
-#include "quantum.h"
+#include <stdint.h>
+#include <stdbool.h>
 
 #define CUTOFF_MS 1000
 
@@ -1,157 +1,59 @@
 #include "pointing_device.h"
 #include "quantum.h"
-#include "rate_meter.h"
-#include "glider.h"
+#include "edge_queue.h"
+#include "hrtimer.h"
 #include "trackball.h"
-#include <math.h>
+#include "trackball_motion.h"
+#include "profile.h"
+#include "kb_config.h"
+#include "edge_record.h"
+#include "sof_sync.h"
 
 #define TB_LEFT  PAL_LINE(GPIOC, 11U)
 #define TB_RIGHT PAL_LINE(GPIOC, 9U)
 #define TB_UP    PAL_LINE(GPIOC, 8U)
 #define TB_DOWN  PAL_LINE(GPIOC, 10U)
 
-#define TB_DECR -1
-#define TB_INCR 1
-
-enum { AXIS_X = 0, AXIS_Y, AXIS_NUM };
-enum { MODE_WHEEL, MODE_MOUSE };
-
-static uint8_t last_mode = MODE_MOUSE;
 static uint16_t last_report = 0;
 volatile bool select_button_pressed = false; // toggled from keymap
-volatile bool precision_mode = false;          // toggled from keymap
-
-static int8_t distances[AXIS_NUM] = {0};
-static rate_meter_t rate_meters[AXIS_NUM] = {0};
-static glider_t gliders[AXIS_NUM] = {0};
-
-static const int16_t WHEEL_DENOM = 24; // Finer grain control for "High Res" feel
-static int16_t wheel_buffer[AXIS_NUM] = {0};
-
-// Anti-rebound / Consistency Filter
-// Low threshold to catch rebounds even on short movements
-#define TB_LOCK_THRESHOLD 3
-// Increased correction limit (2) to absorb double-tick noise bursts which are common
-// with this sensor, ensuring smoothest possible glide.
-#define TB_CORRECT_LIMIT 2
-
-static int16_t consecutive_steps[AXIS_NUM] = {0};
-static int8_t  locked_direction[AXIS_NUM] = {0};
-static int8_t  correction_count[AXIS_NUM] = {0};
-static uint16_t last_axis_activity[AXIS_NUM] = {0};
-
-// Natural Acceleration Curve: High precision at low speeds, power curve at high speeds
-static float rateToVelocityCurve(float input) {
-    float abs_input = fabsf(input);
-    if (abs_input < 0.02f) return 0; // Lower deadzone for finer control
-
-    float x = abs_input - 0.02f;
-    // Polynomial acceleration (x^1.5) for natural feel over long distances
-    float accel = powf(x, 1.5f) / 40.0f;
-    float linear = x / 20.0f;
-
-    return 0.1f + linear + accel; 
-}
-
-static void trackball_move(uint8_t axis, int8_t direction) {
-  // Check for idle reset
-  uint16_t now = timer_read();
-  if (TIMER_DIFF_16(now, last_axis_activity[axis]) > 200) {
-      consecutive_steps[axis] = 0;
-      locked_direction[axis] = 0;
-      correction_count[axis] = 0;
-  }
-  last_axis_activity[axis] = now;
-
-  // Anti-rebound Filter
-  bool is_reverse = (locked_direction[axis] != 0) && (direction != locked_direction[axis]);
-
-  // SCENARIO 1 & 3: Axis Flipping / Rebound Filtering
-  // The EVQWJN007 sensor is prone to reporting reversed direction when the ball is 
-  // shifted slightly (0.01mm) at the edge of a stroke or when pressure is applied.
-  // This can happen on X or Y axis independently.
-  //
-  // STRATEGY: DROP NOISE (Do not invent data)
-  // If we have established momentum (consecutive_steps >= threshold), and detect a sudden reversal,
-  // we assume it is noise and DROP the packet entirely.
-  // - This prevents the "Glider Stop" (Zig-Zag) because we don't send the reverse signal.
-  // - This prevents "Jumping Around" because we don't substitute fake forward motion.
-  // - The cursor simply "Coasts" over the noise.
-
-  if (is_reverse) {
-      if (consecutive_steps[axis] >= TB_LOCK_THRESHOLD) {
-          // Dynamic Limit:
-          // Low Speed: 1 tick check (Fast response for precision)
-          // High Speed: 2 tick check (Suppress mechanical bounce)
-          int8_t limit = (gliders[axis].speed > 1.5f) ? 2 : 1;
-          
-          if (correction_count[axis] < limit) {
-              // IGNORE this event. Treat it as if the hardware never triggered.
-              correction_count[axis]++;
-              return; 
-          } else {
-              // Limit exceeded, accept the reversal as valid user intent
-              locked_direction[axis] = direction;
-              consecutive_steps[axis] = 1;
-              correction_count[axis] = 0;
-          }
-      } else {
-          // Not enough momentum to filter, accept immediately (allows micro-adjustments)
-          locked_direction[axis] = direction;
-          consecutive_steps[axis] = 1;
-          correction_count[axis] = 0;
-      }
-  } else {
-      // Continuing same direction
-      if (direction == locked_direction[axis]) {
-          if (consecutive_steps[axis] < 32000) consecutive_steps[axis]++;
-          correction_count[axis] = 0;
-      } else {
-          // First move from rest
-          locked_direction[axis] = direction;
-          consecutive_steps[axis] = 1;
-          correction_count[axis] = 0;
-      }
-  }
-
-  // Always update distances[], regardless of the mode
-  distances[axis] += direction;
 
-  // Always run glider/rate meter updates to allow momentum in both modes
-  {
-    rate_meter_interrupt(&rate_meters[axis]);
-    glider_set_direction(&gliders[axis], direction);
+static const uint16_t cpi_steps[] = {100, 200, 300, 400, 600, 800, 1200, 1600};
+#define CPI_STEP_NUM ((uint8_t)(sizeof(cpi_steps) / sizeof(cpi_steps[0])))
+static uint16_t trackball_cpi = TRACKBALL_DEFAULT_CPI;
 
-    const float rx = rate_meter_rate(&rate_meters[AXIS_X]);
-    const float ry = rate_meter_rate(&rate_meters[AXIS_Y]);
+static curve_profile_t trackball_curve = CURVE_NATURAL;
 
-    const float rate = sqrtf(rx * rx + ry * ry);
-    float velocity = rateToVelocityCurve(rate);
-
-    // Apply precision scaling if enabled
-    if (precision_mode) {
-        velocity *= 0.5f; // 50% speed for high precision
-    }
-
-    const float ratio = (rate > 0) ? (velocity / rate) : 0;
-
-    const float vx = rx * ratio;
-    const float vy = ry * ratio;
-
-    if (axis == AXIS_X) {
-      glider_update(&gliders[AXIS_X], vx, sqrtf(rate_meter_delta(&rate_meters[AXIS_X])));
-      glider_update_speed(&gliders[AXIS_Y], vy);
-    } else {
-      glider_update_speed(&gliders[AXIS_X], vx);
-      glider_update(&gliders[AXIS_Y], vy, sqrtf(rate_meter_delta(&rate_meters[AXIS_Y])));
-    }
-  }
+static void trackball_apply_cpi(uint16_t cpi) {
+  trackball_cpi = MIN(MAX(cpi, TRACKBALL_MIN_CPI), TRACKBALL_MAX_CPI);
+  trackball_motion_set_scale((fix16_t)(((int32_t)trackball_cpi << FIX16_SHIFT) / TRACKBALL_DEFAULT_CPI));
 }
 
-static void trackball_left(void* arg) { (void)arg; trackball_move(AXIS_X, TB_DECR); }
-static void trackball_right(void* arg) { (void)arg; trackball_move(AXIS_X, TB_INCR); }
-static void trackball_up(void* arg) { (void)arg; trackball_move(AXIS_Y, TB_DECR); }
-static void trackball_down(void* arg) { (void)arg; trackball_move(AXIS_Y, TB_INCR); }
+// EXTI callbacks only timestamp the edge; filtering and glider updates happen
+// when pointing_device_driver_get_report() drains the queue.
+static void trackball_left(void* arg) {
+  (void)arg;
+  PROFILE_START(profile_start);
+  edge_queue_push(AXIS_X, TB_DECR, hrtimer_read());
+  PROFILE_STOP(PROFILE_TB_LEFT, profile_start);
+}
+static void trackball_right(void* arg) {
+  (void)arg;
+  PROFILE_START(profile_start);
+  edge_queue_push(AXIS_X, TB_INCR, hrtimer_read());
+  PROFILE_STOP(PROFILE_TB_RIGHT, profile_start);
+}
+static void trackball_up(void* arg) {
+  (void)arg;
+  PROFILE_START(profile_start);
+  edge_queue_push(AXIS_Y, TB_DECR, hrtimer_read());
+  PROFILE_STOP(PROFILE_TB_UP, profile_start);
+}
+static void trackball_down(void* arg) {
+  (void)arg;
+  PROFILE_START(profile_start);
+  edge_queue_push(AXIS_Y, TB_INCR, hrtimer_read());
+  PROFILE_STOP(PROFILE_TB_DOWN, profile_start);
+}
 
 bool pointing_device_driver_init(void) {
     palSetLineMode(TB_LEFT, PAL_MODE_INPUT_PULLUP);
@@ -168,74 +70,183 @@ bool pointing_device_driver_init(void) {
     palSetLineCallback(TB_RIGHT, trackball_right, NULL);
     palSetLineCallback(TB_UP, trackball_up, NULL);
     palSetLineCallback(TB_DOWN, trackball_down, NULL);
+
+    trackball_tuning_load();
+    trackball_apply_cpi(kb_config.cpi ? kb_config.cpi : TRACKBALL_DEFAULT_CPI);
+    if (kb_config.curve >= CURVE_NUM || !trackball_curve_select(kb_config.curve)) {
+        trackball_curve_select(CURVE_NATURAL);
+    }
     return true;
 }
 
 report_mouse_t pointing_device_driver_get_report(report_mouse_t mouse_report) {
-  int8_t x = 0, y = 0, h = 0, v = 0;
-  chSysLock();
+  // Off the frame-aligned scan pass the edges wait in the queue for the next slot
+  if (!sof_sync_slot()) return mouse_report;
+
+  PROFILE_START(profile_start);
+
+  // Process the batch of edges collected since the last report
+  edge_event_t ev;
+  bool moved = false;
+  while (edge_queue_pop(&ev)) {
+    const bool accepted = trackball_move(ev.axis, ev.direction, ev.time);
+    edge_record_add(&ev, !accepted);
+    moved = true;
+  }
 
+  // Motion state is only touched from here: the EXTI callbacks hand edges over
+  // through the lock-free edge queue, so no critical section is needed.
   const uint16_t now = timer_read();
   const uint16_t delta = TIMER_DIFF_16(now, last_report);
   last_report = now;
 
   const uint8_t mode = select_button_pressed ? MODE_WHEEL : MODE_MOUSE;
-  if (last_mode != mode) {
-    rate_meter_expire(&rate_meters[AXIS_X]);
-    rate_meter_expire(&rate_meters[AXIS_Y]);
-    glider_stop(&gliders[AXIS_X]);
-    glider_stop(&gliders[AXIS_Y]);
-    wheel_buffer[AXIS_X] = 0;
-    wheel_buffer[AXIS_Y] = 0;
-    distances[AXIS_X] = 0;
-    distances[AXIS_Y] = 0;
-    consecutive_steps[AXIS_X] = 0; locked_direction[AXIS_X] = 0; correction_count[AXIS_X] = 0;
-    consecutive_steps[AXIS_Y] = 0; locked_direction[AXIS_Y] = 0; correction_count[AXIS_Y] = 0;
+  // With no new edges and nothing gliding the report is all zero; skip the
+  // glide arithmetic. QMK only sends reports with movement or a button change,
+  // so these never reach the host.
+  trackball_motion_t motion = {0};
+  if (moved || !trackball_motion_idle(mode, delta)) {
+    motion = trackball_motion_report(mode, delta);
+  }
+
+  mouse_report.x = motion.x;
+  mouse_report.y = motion.y;
+  mouse_report.h = motion.h;
+  mouse_report.v = -motion.v; // Inverted for natural scroll direction
+
+  PROFILE_STOP(PROFILE_GET_REPORT, profile_start);
+  return mouse_report;
+}
+
+uint16_t pointing_device_driver_get_cpi(void) { return trackball_cpi; }
+
+void pointing_device_driver_set_cpi(uint16_t cpi) {
+  trackball_apply_cpi(cpi);
+  if (kb_config.cpi != trackball_cpi) {
+    kb_config.cpi = trackball_cpi;
+    kb_config_save();
+  }
+}
+
+void trackball_cpi_step(int8_t dir) {
+  // Current position: the first step at or above the (possibly off-step) CPI
+  uint8_t i = 0;
+  while (i < CPI_STEP_NUM - 1 && cpi_steps[i] < trackball_cpi) i++;
+
+  if (dir > 0) {
+    i = (cpi_steps[i] > trackball_cpi) ? i : (i + 1) % CPI_STEP_NUM;
+  } else if (dir < 0) {
+    i = (i == 0) ? CPI_STEP_NUM - 1 : i - 1;
+  }
+  pointing_device_driver_set_cpi(cpi_steps[i]);
+  uprintf("trackball cpi: %u\n", trackball_cpi);
+}
+
+static void trackball_apply_scroll(void) {
+#ifdef POINTING_DEVICE_HIRES_SCROLL_ENABLE
+  trackball_motion_set_wheel_resolution(kb_config.coarse_scroll ? 1 : pointing_device_get_hires_scroll_resolution());
+#else
+  trackball_motion_set_wheel_resolution(1);
+#endif
+}
+
+// The hi-res resolution is only known once pointing_device_init() has run the driver init
+void pointing_device_init_kb(void) {
+  trackball_apply_scroll();
+  pointing_device_init_user();
+}
+
+// Manual fallback for hosts that ignore the Resolution Multiplier and scroll a full detent per count. There is no
+// automatic downgrade: QMK declares the multiplier as a constant Feature item, so a supporting host can apply it without
+// any GET/SET_FEATURE request, and an unsupporting one looks exactly the same from the device side.
+void trackball_scroll_toggle(void) {
+  kb_config.coarse_scroll = !kb_config.coarse_scroll;
+  kb_config_save();
+  trackball_apply_scroll();
+  uprintf("trackball scroll: %s\n", kb_config.coarse_scroll ? "detents" : "hi-res");
+}
+
+bool trackball_curve_select(curve_profile_t profile) {
+  const curve_point_t* points = NULL;
+  uint8_t count = 0;
+  kb_datablock_t data;
+
+  if (profile == CURVE_CUSTOM) {
+    kb_datablock_load(&data);
+    points = data.curve;
+    count = data.curve_count;
   } else {
-    rate_meter_tick(&rate_meters[AXIS_X], delta);
-    rate_meter_tick(&rate_meters[AXIS_Y], delta);
+    points = curve_builtin(profile, &count);
   }
-  last_mode = mode;
-
-  switch(mode){
-    case MODE_MOUSE:
-      x = glider_glide(&gliders[AXIS_X], (uint8_t)delta);
-      y = glider_glide(&gliders[AXIS_Y], (uint8_t)delta);
-      distances[AXIS_X] = 0;
-      distances[AXIS_Y] = 0;
-      break;
-    case MODE_WHEEL:
-      // Use glider for smoothed momentum scrolling
-      // Accumulate smoothed movement into wheel buffer
-      // Note: We use the same gliders as mouse mode for consistent feel
-      wheel_buffer[AXIS_X] += glider_glide(&gliders[AXIS_X], (uint8_t)delta);
-      wheel_buffer[AXIS_Y] += glider_glide(&gliders[AXIS_Y], (uint8_t)delta);
-      
-      // Calculate scroll amount from accumulated buffer
-      h = wheel_buffer[AXIS_X] / WHEEL_DENOM;
-      v = wheel_buffer[AXIS_Y] / WHEEL_DENOM;
-      
-      // Keep remainder in buffer for next report
-      wheel_buffer[AXIS_X] -= h * WHEEL_DENOM;
-      wheel_buffer[AXIS_Y] -= v * WHEEL_DENOM;
-      
-      // Clear raw distances (consumed by glider logic in trackball_move/glider_glide updates)
-      distances[AXIS_X] = 0;
-      distances[AXIS_Y] = 0;
-      break;
+  if (!trackball_motion_set_curve(points, count)) return false;
+
+  trackball_curve = profile;
+  if (kb_config.curve != profile) {
+    kb_config.curve = profile;
+    kb_config_save();
   }
-  chSysUnlock();
+  return true;
+}
 
-  mouse_report.x = x;
-  mouse_report.y = y;
-  mouse_report.h = h;
-  mouse_report.v = -v; // Inverted for natural scroll direction
-  return mouse_report;
+void trackball_curve_cycle(void) {
+  curve_profile_t next = (trackball_curve + 1) % CURVE_NUM;
+  if (!trackball_curve_select(next)) {
+    // Only CURVE_CUSTOM can fail, and it is the last profile
+    next = CURVE_NATURAL;
+    trackball_curve_select(next);
+  }
+  uprintf("trackball curve: %u\n", next);
+}
+
+bool trackball_curve_store(const curve_point_t* points, uint8_t count) {
+  if (!curve_valid(points, count)) return false;
+
+  kb_datablock_t data;
+  kb_datablock_load(&data);
+  memset(data.curve, 0, sizeof(data.curve));
+  data.curve_count = count;
+  memcpy(data.curve, points, count * sizeof(curve_point_t));
+  kb_datablock_save(&data);
+  return trackball_curve_select(CURVE_CUSTOM);
+}
+
+curve_profile_t trackball_curve_get(curve_point_t* points, uint8_t* count) {
+  if (trackball_curve == CURVE_CUSTOM) {
+    kb_datablock_t data;
+    kb_datablock_load(&data);
+    *count = data.curve_count;
+    memcpy(points, data.curve, sizeof(data.curve));
+  } else {
+    const curve_point_t* table = curve_builtin(trackball_curve, count);
+    memcpy(points, table, *count * sizeof(curve_point_t));
+  }
+  return trackball_curve;
+}
+
+void trackball_tuning_reset(void) {
+  static const trackball_tuning_t defaults = TRACKBALL_TUNING_DEFAULTS;
+  trackball_motion_set_tuning(&defaults);
 }
 
-uint16_t pointing_device_driver_get_cpi(void) { return 0; }
-void pointing_device_driver_set_cpi(uint16_t cpi) { (void)cpi; }
+void trackball_tuning_load(void) {
+  kb_datablock_t data;
+  kb_datablock_load(&data);
+  if (!data.tuning_stored || !trackball_motion_set_tuning(&data.tuning)) {
+    trackball_tuning_reset();
+  }
+}
+
+void trackball_tuning_save(void) {
+  kb_datablock_t data;
+  kb_datablock_load(&data);
+  data.tuning_stored = 1;
+  data.tuning = *trackball_motion_get_tuning();
+  kb_datablock_save(&data);
+}
 
 bool process_record_kb(uint16_t keycode, keyrecord_t *record) {
-    return process_record_user(keycode, record);
+    PROFILE_START(profile_start);
+    const bool ret = process_record_user(keycode, record);
+    PROFILE_STOP(PROFILE_PROCESS_RECORD, profile_start);
+    return ret;
 }
\ No newline at end of file
@@ -2,6 +2,19 @@
 #define TRACKBALL_H
 
 #include "quantum.h"
+#include "trackball_curve.h"
+
+/* Nominal CPI of the native (unscaled) motion; other CPI values scale the
+ * velocity proportionally. set_cpi() clamps to the MIN/MAX range. */
+#ifndef TRACKBALL_DEFAULT_CPI
+#    define TRACKBALL_DEFAULT_CPI 400
+#endif
+#ifndef TRACKBALL_MIN_CPI
+#    define TRACKBALL_MIN_CPI 100
+#endif
+#ifndef TRACKBALL_MAX_CPI
+#    define TRACKBALL_MAX_CPI 1600
+#endif
 
 /**
  * @brief Initializes the trackball hardware, GPIOs, and interrupts.
@@ -20,22 +33,70 @@ report_mouse_t pointing_device_driver_get_report(report_mouse_t mouse_report);
 
 /**
  * @brief Returns the current CPI (Counts Per Inch) setting.
- * Currently returns 0 as a placeholder.
  */
 uint16_t pointing_device_driver_get_cpi(void);
 
 /**
- * @brief Sets the CPI (Counts Per Inch) for the trackball.
- * @param cpi The desired CPI value.
+ * @brief Sets the CPI (Counts Per Inch) for the trackball and stores it in EEPROM.
+ * @param cpi The desired CPI value, clamped to TRACKBALL_MIN_CPI..TRACKBALL_MAX_CPI.
  */
 void pointing_device_driver_set_cpi(uint16_t cpi);
 
+/**
+ * @brief Moves to the next (dir > 0) or previous (dir < 0) CPI step, wrapping around.
+ */
+void trackball_cpi_step(int8_t dir);
+
 /**
  * @brief Standard QMK record processing.
  * Detects the JS_4 keypress to toggle between cursor movement and scroll wheel modes.
  */
 bool process_record_kb(uint16_t keycode, keyrecord_t *record);
 
+/**
+ * @brief Switches to a velocity curve profile and stores the choice in EEPROM.
+ * @return false if the profile is CURVE_CUSTOM and no valid custom table is stored.
+ */
+bool trackball_curve_select(curve_profile_t profile);
+
+/**
+ * @brief Cycles to the next curve profile, skipping CURVE_CUSTOM when none is stored.
+ */
+void trackball_curve_cycle(void);
+
+/**
+ * @brief Validates a custom curve, writes it to EEPROM and selects it.
+ * @return false (nothing stored) if the table is not valid, see curve_valid().
+ */
+bool trackball_curve_store(const curve_point_t* points, uint8_t count);
+
+/**
+ * @brief Returns the active profile and copies its table into `points` (up to CURVE_MAX_POINTS).
+ */
+curve_profile_t trackball_curve_get(curve_point_t* points, uint8_t* count);
+
+/**
+ * @brief Toggles between high-resolution and classic detent scrolling, stored in EEPROM.
+ * The device cannot tell whether the host honours the HID resolution multiplier, so
+ * hosts that scroll far too fast in wheel mode should be switched to detents.
+ */
+void trackball_scroll_toggle(void);
+
+/**
+ * @brief Applies the tuning stored in EEPROM, or the defaults if none is stored.
+ */
+void trackball_tuning_load(void);
+
+/**
+ * @brief Restores the default tuning. EEPROM is untouched until trackball_tuning_save().
+ */
+void trackball_tuning_reset(void);
+
+/**
+ * @brief Stores the live tuning (trackball_motion_get_tuning()) in EEPROM.
+ */
+void trackball_tuning_save(void);
+
 /* Precision mode toggle: when true, cursor movement is reduced for fine control.
  * Toggled by holding Select and clicking the trackball middle button.
  */
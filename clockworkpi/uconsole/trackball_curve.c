@@ -0,0 +1,89 @@
+#include <stddef.h>
+#include "trackball_curve.h"
+
+// Breakpoints are denser at low rates, where the curve bends the most
+static const curve_point_t curve_natural[] = {
+  {FIX16_CONST(0.02), FIX16_CONST(0.1)},       {FIX16_CONST(0.5), FIX16_CONST(0.1323)},
+  {FIX16_CONST(1.5), FIX16_CONST(0.219)},      {FIX16_CONST(4), FIX16_CONST(0.4975)},
+  {FIX16_CONST(9), FIX16_CONST(1.2218)},       {FIX16_CONST(18), FIX16_CONST(2.905)},
+  {FIX16_CONST(34), FIX16_CONST(6.7509)},      {FIX16_CONST(62), FIX16_CONST(15.3978)},
+  {FIX16_CONST(110), FIX16_CONST(34.4334)},    {FIX16_CONST(190), FIX16_CONST(75.0629)},
+  {FIX16_CONST(330), FIX16_CONST(166.4541)},   {FIX16_CONST(560), FIX16_CONST(359.3817)},
+  {FIX16_CONST(950), FIX16_CONST(779.6)},      {FIX16_CONST(1600), FIX16_CONST(1680.069)},
+  {FIX16_CONST(2600), FIX16_CONST(3444.4234)}, {FIX16_CONST(4000), FIX16_CONST(6524.6069)},
+};
+
+// No acceleration: 0.3 counts per edge/s, same as "natural" around 100 edges/s
+static const curve_point_t curve_linear[] = {
+  {FIX16_CONST(0.02), FIX16_CONST(0.1)}, {FIX16_CONST(4000), FIX16_CONST(1200.094)},
+};
+
+// 0.1 + x/20 + x^1.5/30: a third more acceleration than "natural"
+static const curve_point_t curve_aggressive[] = {
+  {FIX16_CONST(0.02), FIX16_CONST(0.1)},       {FIX16_CONST(0.5), FIX16_CONST(0.1351)},
+  {FIX16_CONST(1.5), FIX16_CONST(0.234)},      {FIX16_CONST(4), FIX16_CONST(0.5637)},
+  {FIX16_CONST(9), FIX16_CONST(1.446)},        {FIX16_CONST(18), FIX16_CONST(3.5403)},
+  {FIX16_CONST(34), FIX16_CONST(8.4016)},      {FIX16_CONST(62), FIX16_CONST(19.4641)},
+  {FIX16_CONST(110), FIX16_CONST(44.0448)},    {FIX16_CONST(190), FIX16_CONST(96.8842)},
+  {FIX16_CONST(330), FIX16_CONST(216.4058)},   {FIX16_CONST(560), FIX16_CONST(469.8093)},
+  {FIX16_CONST(950), FIX16_CONST(1023.6004)},  {FIX16_CONST(1600), FIX16_CONST(2213.3923)},
+  {FIX16_CONST(2600), FIX16_CONST(4549.1983)}, {FIX16_CONST(4000), FIX16_CONST(8191)},
+};
+
+#define CURVE_LEN(table) ((uint8_t)(sizeof(table) / sizeof((table)[0])))
+
+const curve_point_t* curve_builtin(curve_profile_t profile, uint8_t* count) {
+  switch (profile) {
+    case CURVE_NATURAL:
+      *count = CURVE_LEN(curve_natural);
+      return curve_natural;
+    case CURVE_LINEAR:
+      *count = CURVE_LEN(curve_linear);
+      return curve_linear;
+    case CURVE_AGGRESSIVE:
+      *count = CURVE_LEN(curve_aggressive);
+      return curve_aggressive;
+    default:
+      *count = 0;
+      return NULL;
+  }
+}
+
+bool curve_valid(const curve_point_t* points, uint8_t count) {
+  if (points == NULL || count < 2 || count > CURVE_MAX_POINTS) return false;
+  for (uint8_t i = 0; i < count; i++) {
+    if (points[i].x < 0 || points[i].y < 0 || points[i].y > CURVE_MAX_Y) return false;
+    if (i > 0 && points[i].x <= points[i - 1].x) return false;
+  }
+  return true;
+}
+
+bool curve_load(curve_t* curve, const curve_point_t* points, uint8_t count) {
+  if (!curve_valid(points, count)) return false;
+
+  curve->count = count;
+  for (uint8_t i = 0; i < count; i++) {
+    curve->points[i] = points[i];
+  }
+  for (uint8_t i = 0; i + 1 < count; i++) {
+    // Saturate both ways: a custom table may put breakpoints very close
+    // together, rising or falling
+    int64_t slope = ((int64_t)(points[i + 1].y - points[i].y) << FIX16_SHIFT) / (points[i + 1].x - points[i].x);
+    curve->slopes[i] = (fix16_t)(slope > INT32_MAX ? INT32_MAX : slope < INT32_MIN ? INT32_MIN : slope);
+  }
+  curve->slopes[count - 1] = curve->slopes[count - 2];
+  return true;
+}
+
+fix16_t curve_eval(const curve_t* curve, fix16_t x) {
+  if (curve->count == 0 || x < curve->points[0].x) return 0;
+
+  // Last breakpoint at or below x; a handful of compares at most
+  uint8_t i = curve->count - 1;
+  while (x < curve->points[i].x) i--;
+
+  int64_t y = curve->points[i].y + (((int64_t)(x - curve->points[i].x) * curve->slopes[i]) >> FIX16_SHIFT);
+  if (y < 0) return 0;
+  if (y > CURVE_MAX_Y) return CURVE_MAX_Y;
+  return (fix16_t)y;
+}
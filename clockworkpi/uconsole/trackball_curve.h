@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fixed_point.h"
+
+/*
+ * Piecewise-linear velocity curves for the trackball.
+ *
+ * A curve maps the combined rate from the rate meters (edges/s divided by
+ * 1 << RATE_METER_GAIN_SHIFT, see rate_meter.h) to a glider velocity through
+ * up to CURVE_MAX_POINTS breakpoints with strictly increasing x. Rates below
+ * the first breakpoint are the deadzone and map to 0; rates past the last one
+ * continue on the last segment. Outputs are capped at CURVE_MAX_Y so that the
+ * CPI scale (at most 4x) cannot overflow Q16.16.
+ *
+ * The built-in "natural" table reproduces the former closed-form curve
+ * 0.1 + x/20 + x^1.5/40 (x past a 0.02 deadzone) to within 3% above 0.03
+ * edges/s.
+ */
+#define CURVE_MAX_POINTS 16
+#define CURVE_MAX_Y FIX16_CONST(8191)
+
+typedef enum {
+  CURVE_NATURAL = 0,
+  CURVE_LINEAR,
+  CURVE_AGGRESSIVE,
+  CURVE_CUSTOM, // user table from EEPROM
+  CURVE_NUM
+} curve_profile_t;
+
+typedef struct {
+  fix16_t x; // rate meter output
+  fix16_t y; // velocity
+} curve_point_t;
+
+// Ready-to-evaluate curve: breakpoints plus the precomputed segment slopes
+typedef struct {
+  uint8_t count;
+  curve_point_t points[CURVE_MAX_POINTS];
+  fix16_t slopes[CURVE_MAX_POINTS];
+} curve_t;
+
+/**
+ * @brief Returns the table of a built-in profile, NULL for CURVE_CUSTOM.
+ */
+const curve_point_t* curve_builtin(curve_profile_t profile, uint8_t* count);
+
+/**
+ * @brief Checks a table: 2..CURVE_MAX_POINTS points, x strictly increasing, 0 <= y <= CURVE_MAX_Y.
+ */
+bool curve_valid(const curve_point_t* points, uint8_t count);
+
+/**
+ * @brief Copies a valid table into `curve` and precomputes the slopes.
+ * @return false (leaving `curve` untouched) if the table is not valid.
+ */
+bool curve_load(curve_t* curve, const curve_point_t* points, uint8_t count);
+
+fix16_t curve_eval(const curve_t* curve, fix16_t x);
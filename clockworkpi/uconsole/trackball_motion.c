@@ -0,0 +1,264 @@
+#include "trackball_motion.h"
+#include "rate_meter.h"
+#include "glider.h"
+
+/*
+ * Trackball motion pipeline: anti-rebound filter, rate meters, velocity curve
+ * and gliders. Nothing in here touches QMK, ChibiOS or the hardware; inputs
+ * are timestamped edges and the elapsed time per report, so the same code can
+ * be built and driven on a host.
+ */
+
+volatile bool precision_mode = false; // toggled from keymap
+
+static uint8_t last_mode = MODE_MOUSE;
+static fix16_t velocity_scale = FIX16_ONE;
+static curve_t velocity_curve = {0}; // no motion until a curve is set
+
+static int8_t distances[AXIS_NUM] = {0};
+static rate_meter_t rate_meters[AXIS_NUM] = {0};
+static glider_t gliders[AXIS_NUM] = {0};
+
+static trackball_tuning_t tuning = TRACKBALL_TUNING_DEFAULTS;
+// Wheel units per detent: 1 for classic wheels, the HID resolution multiplier
+// (e.g. 120) when the host scrolls in high-resolution units
+static uint16_t wheel_resolution = 1;
+static int32_t wheel_buffer[AXIS_NUM] = {0}; // glider counts * wheel_resolution
+
+// Anti-rebound / Consistency Filter
+// A low lock threshold catches rebounds even on short movements; a correction
+// limit of 2 at speed absorbs the double-tick noise bursts which are common
+// with this sensor, ensuring smoothest possible glide. See tuning above.
+
+static int16_t consecutive_steps[AXIS_NUM] = {0};
+static int8_t  locked_direction[AXIS_NUM] = {0};
+static int8_t  correction_count[AXIS_NUM] = {0};
+static uint32_t last_axis_activity[AXIS_NUM] = {0};
+
+bool trackball_motion_set_curve(const curve_point_t* points, uint8_t count) {
+  return curve_load(&velocity_curve, points, count);
+}
+
+void trackball_motion_set_scale(fix16_t scale) {
+  velocity_scale = scale;
+}
+
+bool trackball_motion_set_tuning(const trackball_tuning_t* t) {
+  if (t->wheel_denom == 0 || t->idle_reset_ms == 0 || t->precision_scale <= 0) return false;
+  tuning = *t;
+  return true;
+}
+
+const trackball_tuning_t* trackball_motion_get_tuning(void) {
+  return &tuning;
+}
+
+void trackball_motion_telemetry(trackball_telemetry_t* out, uint32_t now) {
+  for (uint8_t axis = 0; axis < AXIS_NUM; axis++) {
+    out->rate[axis]    = rate_meter_rate(&rate_meters[axis], now);
+    out->speed[axis]   = gliders[axis].direction * gliders[axis].speed;
+    out->sustain[axis] = gliders[axis].sustain;
+    out->release[axis] = gliders[axis].release;
+  }
+}
+
+void trackball_motion_set_wheel_resolution(uint16_t units_per_detent) {
+  wheel_resolution = units_per_detent ? units_per_detent : 1;
+  wheel_buffer[AXIS_X] = 0;
+  wheel_buffer[AXIS_Y] = 0;
+}
+
+// Whole wheel units in the buffer, keeping the sub-unit remainder for the next
+// report. Anything past TRACKBALL_WHEEL_MAX is dropped rather than carried,
+// like the glider's own per-report clamp, so scrolling never lags behind.
+static int16_t wheel_take(int32_t* buffer) {
+  int32_t units = *buffer / tuning.wheel_denom;
+  *buffer -= units * tuning.wheel_denom;
+  if (units > TRACKBALL_WHEEL_MAX) units = TRACKBALL_WHEEL_MAX;
+  if (units < -TRACKBALL_WHEEL_MAX) units = -TRACKBALL_WHEEL_MAX;
+  return (int16_t)units;
+}
+
+// Glider sustain in ms from the averaged edge interval: sqrt(delta in ms),
+// keeping the sub-millisecond part of the interval.
+static uint16_t sustain_from_delta(uint32_t delta_us) {
+  return isqrt32(delta_us * 1000) / 1000;
+}
+
+// Glider release (coast) time: fast movements glide longer before stopping
+static uint16_t release_from_speed(fix16_t speed, uint16_t sustain) {
+  if (speed <= tuning.boost_speed) return sustain;
+  const int64_t boost = ((int64_t)speed * tuning.boost_ms) >> (2 * FIX16_SHIFT);
+  const int64_t room = UINT16_MAX - sustain;
+  return sustain + (uint16_t)(boost < room ? boost : room);
+}
+
+bool trackball_move(uint8_t axis, int8_t direction, uint32_t now) {
+  // Check for idle reset
+  if ((uint32_t)(now - last_axis_activity[axis]) > (uint32_t)tuning.idle_reset_ms * 1000) {
+      consecutive_steps[axis] = 0;
+      locked_direction[axis] = 0;
+      correction_count[axis] = 0;
+  }
+  last_axis_activity[axis] = now;
+
+  // Anti-rebound Filter
+  bool is_reverse = (locked_direction[axis] != 0) && (direction != locked_direction[axis]);
+
+  // SCENARIO 1 & 3: Axis Flipping / Rebound Filtering
+  // The EVQWJN007 sensor is prone to reporting reversed direction when the ball is 
+  // shifted slightly (0.01mm) at the edge of a stroke or when pressure is applied.
+  // This can happen on X or Y axis independently.
+  //
+  // STRATEGY: DROP NOISE (Do not invent data)
+  // If we have established momentum (consecutive_steps >= threshold), and detect a sudden reversal,
+  // we assume it is noise and DROP the packet entirely.
+  // - This prevents the "Glider Stop" (Zig-Zag) because we don't send the reverse signal.
+  // - This prevents "Jumping Around" because we don't substitute fake forward motion.
+  // - The cursor simply "Coasts" over the noise.
+
+  if (is_reverse) {
+      if (consecutive_steps[axis] >= tuning.lock_threshold) {
+          // Dynamic Limit:
+          // Low Speed: 1 tick check (Fast response for precision)
+          // High Speed: correct_limit tick check (Suppress mechanical bounce)
+          int8_t limit = (gliders[axis].speed > tuning.correct_speed) ? tuning.correct_limit : (tuning.correct_limit < 1 ? tuning.correct_limit : 1);
+          
+          if (correction_count[axis] < limit) {
+              // IGNORE this event. Treat it as if the hardware never triggered.
+              correction_count[axis]++;
+              return false;
+          } else {
+              // Limit exceeded, accept the reversal as valid user intent
+              locked_direction[axis] = direction;
+              consecutive_steps[axis] = 1;
+              correction_count[axis] = 0;
+          }
+      } else {
+          // Not enough momentum to filter, accept immediately (allows micro-adjustments)
+          locked_direction[axis] = direction;
+          consecutive_steps[axis] = 1;
+          correction_count[axis] = 0;
+      }
+  } else {
+      // Continuing same direction
+      if (direction == locked_direction[axis]) {
+          if (consecutive_steps[axis] < 32000) consecutive_steps[axis]++;
+          correction_count[axis] = 0;
+      } else {
+          // First move from rest
+          locked_direction[axis] = direction;
+          consecutive_steps[axis] = 1;
+          correction_count[axis] = 0;
+      }
+  }
+
+  // Always update distances[], regardless of the mode
+  distances[axis] += direction;
+
+  // Always run glider/rate meter updates to allow momentum in both modes
+  {
+    rate_meter_interrupt(&rate_meters[axis], now);
+    glider_set_direction(&gliders[axis], direction);
+
+    const fix16_t rx = rate_meter_rate(&rate_meters[AXIS_X], now);
+    const fix16_t ry = rate_meter_rate(&rate_meters[AXIS_Y], now);
+
+    const fix16_t rate = fix16_hypot(rx, ry);
+    fix16_t velocity = fix16_mul(curve_eval(&velocity_curve, rate), velocity_scale);
+
+    // Apply precision scaling if enabled
+    if (precision_mode) {
+        velocity = fix16_mul(velocity, tuning.precision_scale); // 50% speed by default
+    }
+
+    // Split the velocity back onto the axes: v * (r_axis / rate), widened so the
+    // ratio keeps its precision.
+    const fix16_t vx = (rate > 0) ? (fix16_t)((int64_t)rx * velocity / rate) : 0;
+    const fix16_t vy = (rate > 0) ? (fix16_t)((int64_t)ry * velocity / rate) : 0;
+
+    if (axis == AXIS_X) {
+      const uint16_t sustain = sustain_from_delta(rate_meter_delta(&rate_meters[AXIS_X]));
+      glider_update(&gliders[AXIS_X], vx, sustain, release_from_speed(vx, sustain));
+      glider_update_speed(&gliders[AXIS_Y], vy);
+    } else {
+      const uint16_t sustain = sustain_from_delta(rate_meter_delta(&rate_meters[AXIS_Y]));
+      glider_update_speed(&gliders[AXIS_X], vx);
+      glider_update(&gliders[AXIS_Y], vy, sustain, release_from_speed(vy, sustain));
+    }
+  }
+  return true;
+}
+
+// A whole wheel unit is waiting in the buffer (the remainder alone never is,
+// unless the tuning lowered wheel_denom since)
+static bool wheel_pending(int32_t buffer) {
+  return buffer >= tuning.wheel_denom || buffer <= -(int32_t)tuning.wheel_denom;
+}
+
+// A glider with no speed, sustain or release left only changes on the next edge
+static bool glider_idle(const glider_t* gr) {
+  return gr->speed == 0 && gr->sustain == 0 && gr->release == 0;
+}
+
+bool trackball_motion_idle(uint8_t mode, uint16_t delta) {
+  if (mode != last_mode || !glider_idle(&gliders[AXIS_X]) || !glider_idle(&gliders[AXIS_Y])) {
+    return false;
+  }
+  if (mode == MODE_WHEEL && (wheel_pending(wheel_buffer[AXIS_X]) || wheel_pending(wheel_buffer[AXIS_Y]))) {
+    return false;
+  }
+  // Same bookkeeping trackball_motion_report() does, so the cutoffs still
+  // expire on time while reports are skipped
+  rate_meter_tick(&rate_meters[AXIS_X], delta);
+  rate_meter_tick(&rate_meters[AXIS_Y], delta);
+  return true;
+}
+
+trackball_motion_t trackball_motion_report(uint8_t mode, uint16_t delta) {
+  trackball_motion_t out = {0};
+
+  if (last_mode != mode) {
+    rate_meter_expire(&rate_meters[AXIS_X]);
+    rate_meter_expire(&rate_meters[AXIS_Y]);
+    glider_stop(&gliders[AXIS_X]);
+    glider_stop(&gliders[AXIS_Y]);
+    wheel_buffer[AXIS_X] = 0;
+    wheel_buffer[AXIS_Y] = 0;
+    distances[AXIS_X] = 0;
+    distances[AXIS_Y] = 0;
+    consecutive_steps[AXIS_X] = 0; locked_direction[AXIS_X] = 0; correction_count[AXIS_X] = 0;
+    consecutive_steps[AXIS_Y] = 0; locked_direction[AXIS_Y] = 0; correction_count[AXIS_Y] = 0;
+  } else {
+    rate_meter_tick(&rate_meters[AXIS_X], delta);
+    rate_meter_tick(&rate_meters[AXIS_Y], delta);
+  }
+  last_mode = mode;
+
+  switch(mode){
+    case MODE_MOUSE:
+      out.x = glider_glide(&gliders[AXIS_X], delta);
+      out.y = glider_glide(&gliders[AXIS_Y], delta);
+      distances[AXIS_X] = 0;
+      distances[AXIS_Y] = 0;
+      break;
+    case MODE_WHEEL:
+      // Use glider for smoothed momentum scrolling
+      // Accumulate smoothed movement into wheel buffer
+      // Note: We use the same gliders as mouse mode for consistent feel
+      wheel_buffer[AXIS_X] += glider_glide(&gliders[AXIS_X], delta) * wheel_resolution;
+      wheel_buffer[AXIS_Y] += glider_glide(&gliders[AXIS_Y], delta) * wheel_resolution;
+      
+      // Calculate scroll amount from accumulated buffer, keeping the remainder
+      // for the next report. In high-resolution mode every count scrolls.
+      out.h = wheel_take(&wheel_buffer[AXIS_X]);
+      out.v = wheel_take(&wheel_buffer[AXIS_Y]);
+      
+      // Clear raw distances (consumed by glider logic in trackball_move/glider_glide updates)
+      distances[AXIS_X] = 0;
+      distances[AXIS_Y] = 0;
+      break;
+  }
+
+  return out;
+}
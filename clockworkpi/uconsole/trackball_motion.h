@@ -0,0 +1,121 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fixed_point.h"
+#include "trackball_curve.h"
+
+enum { AXIS_X = 0, AXIS_Y, AXIS_NUM };
+enum { MODE_WHEEL, MODE_MOUSE };
+
+#define TB_DECR -1
+#define TB_INCR 1
+
+// Largest wheel value per report: WHEEL_EXTENDED_REPORT widens the report's
+// wheel fields to 16 bits, which high-resolution units need at speed
+#ifdef WHEEL_EXTENDED_REPORT
+#  define TRACKBALL_WHEEL_MAX 32767
+#else
+#  define TRACKBALL_WHEEL_MAX 127
+#endif
+
+/*
+ * Filter and glider parameters that can be changed at runtime (raw HID) and
+ * stored in the EEPROM datablock. Laid out without padding so the stored
+ * form does not depend on the compiler.
+ */
+typedef struct {
+  uint8_t  lock_threshold;  // same-direction steps before reversals are treated as rebounds
+  uint8_t  correct_limit;   // rebounds dropped in a row above correct_speed (1 below it)
+  uint16_t idle_reset_ms;   // axis idle time that clears the rebound filter
+  uint16_t wheel_denom;     // glider counts per wheel detent
+  uint16_t reserved;
+  fix16_t  correct_speed;   // glider speed above which correct_limit applies
+  fix16_t  precision_scale; // velocity multiplier in precision mode
+  fix16_t  boost_speed;     // glider speed above which the release is lengthened
+  fix16_t  boost_ms;        // release lengthening in ms per unit of speed
+} trackball_tuning_t;
+
+#define TRACKBALL_TUNING_DEFAULTS { \
+  .lock_threshold  = 3, \
+  .correct_limit   = 2, \
+  .idle_reset_ms   = 200, \
+  .wheel_denom     = 24, \
+  .correct_speed   = FIX16_CONST(1.5), \
+  .precision_scale = FIX16_CONST(0.5), \
+  .boost_speed     = FIX16_CONST(2.0), \
+  .boost_ms        = FIX16_CONST(10), \
+}
+
+// Live motion state for telemetry; speeds are signed by the glide direction
+typedef struct {
+  fix16_t  rate[AXIS_NUM];  // rate meter output (curve input)
+  fix16_t  speed[AXIS_NUM]; // glider speed, counts/ms
+  uint16_t sustain[AXIS_NUM];
+  uint16_t release[AXIS_NUM];
+} trackball_telemetry_t;
+
+typedef struct {
+  int8_t x;
+  int8_t y;
+  int16_t h;
+  int16_t v; // not yet inverted for natural scrolling
+} trackball_motion_t;
+
+/**
+ * @brief Replaces the rate-to-velocity curve.
+ * @return false (keeping the current curve) if the table is not valid, see curve_valid().
+ */
+bool trackball_motion_set_curve(const curve_point_t* points, uint8_t count);
+
+/**
+ * @brief Sets the sensitivity multiplier applied after the velocity curve.
+ * FIX16_ONE is the native feel; the driver derives it from the CPI setting.
+ */
+void trackball_motion_set_scale(fix16_t scale);
+
+/**
+ * @brief Sets how many wheel units make one detent on the host.
+ * 1 reproduces classic detent scrolling (one unit per WHEEL_DENOM glider
+ * counts); a HID resolution multiplier such as 120 makes every count scroll.
+ */
+void trackball_motion_set_wheel_resolution(uint16_t units_per_detent);
+
+/**
+ * @brief Replaces the filter and glider parameters.
+ * @return false (keeping the current set) if a value would break the pipeline,
+ * such as a zero wheel_denom or a non-positive precision_scale.
+ */
+bool trackball_motion_set_tuning(const trackball_tuning_t* tuning);
+const trackball_tuning_t* trackball_motion_get_tuning(void);
+
+/**
+ * @brief Snapshot of the rate meters and gliders at `now` (microseconds).
+ */
+void trackball_motion_telemetry(trackball_telemetry_t* out, uint32_t now);
+
+/**
+ * @brief Feeds one sensor edge through the anti-rebound filter, rate meters and gliders.
+ * @param axis AXIS_X or AXIS_Y.
+ * @param direction TB_DECR or TB_INCR.
+ * @param now Edge timestamp in microseconds (wrapping 32-bit counter).
+ * @return false if the anti-rebound filter dropped the edge.
+ */
+bool trackball_move(uint8_t axis, int8_t direction, uint32_t now);
+
+/**
+ * @brief Advances the gliders by `delta` ms and returns the movement for one report.
+ * A change of `mode` since the previous call resets all motion state.
+ */
+trackball_motion_t trackball_motion_report(uint8_t mode, uint16_t delta);
+
+/**
+ * @brief Fast path for a report without new edges.
+ * When both gliders are stopped, no whole wheel unit is buffered and `mode` is
+ * unchanged, the report would be all zero: advances the rate meter cutoffs by
+ * `delta` ms and returns true. Otherwise returns false and changes nothing;
+ * call trackball_motion_report() instead.
+ */
+bool trackball_motion_idle(uint8_t mode, uint16_t delta);
+
+extern volatile bool precision_mode;
@@ -1,4 +1,11 @@
 #include "quantum.h"
+#include "hrtimer.h"
+#include "profile.h"
+#include "latency.h"
+#include "kb_config.h"
+#include "hid_protocol.h"
+#include "gamepad.h"
+#include "power.h"
 
 // Helper to safely clear the backup register
 void clear_bootloader_flag(void) {
@@ -17,9 +24,21 @@ void clear_bootloader_flag(void) {
 
 void keyboard_pre_init_kb(void) {
     clear_bootloader_flag();
+    hrtimer_init();
+    kb_config_load();
+    gamepad_init();
+    profile_init();
     keyboard_pre_init_user();
 }
 
+void housekeeping_task_kb(void) {
+    latency_task();
+    hid_protocol_task();
+    gamepad_task();
+    housekeeping_task_user();
+    power_task(); // may sleep until the next interrupt, so it goes last
+}
+
 void mcu_reset(void) {
     clear_bootloader_flag();
     NVIC_SystemReset();
@@ -34,9 +53,36 @@ void bootloader_jump(void) {
 #    include <hal.h>
 #    define USER_PWM_MODE PWM_OUTPUT_ACTIVE_HIGH
 
+/*
+ * Backlight fades and breathing run on DMA: every TIM1 update event requests
+ * DMA1 channel 5, which copies the next duty cycle from a ramp into CCR1. The
+ * repetition counter sets how many PWM periods each step lasts, so once a
+ * transfer is started the CPU is not involved until the next change. If
+ * another driver already owns the channel, levels are set directly and
+ * changes are instant.
+ */
+#    define BL_PWM_FREQUENCY 10000000
+#    define BL_PWM_PERIOD 2000
+#    define BL_PWM_HZ (BL_PWM_FREQUENCY / BL_PWM_PERIOD)
+#    define BL_RAMP_STEPS 64
+#    define BL_BREATH_STEPS 128
+// PWM periods per step of a level change: 63 steps x 20 x 200 us ~ 250 ms full scale
+#    ifndef BACKLIGHT_FADE_PERIODS
+#        define BACKLIGHT_FADE_PERIODS 20
+#    endif
+_Static_assert(BACKLIGHT_FADE_PERIODS >= 1 && BACKLIGHT_FADE_PERIODS <= 256, "TIM1 repetition counter is 8 bits");
+// Ramp step of backlight level 1; the levels above it are spread evenly up to
+// full duty. Step 16 is ~5% duty, dim but clearly lit.
+#    ifndef BACKLIGHT_MIN_STEP
+#        define BACKLIGHT_MIN_STEP 16
+#    endif
+_Static_assert(BACKLIGHT_MIN_STEP >= 1 && BACKLIGHT_MIN_STEP < BL_RAMP_STEPS, "BACKLIGHT_MIN_STEP must be on the ramp");
+#    define BL_LEVEL_SPAN (BACKLIGHT_LEVELS > 1 ? BACKLIGHT_LEVELS - 1 : 1)
+#    define BL_DMA_STREAM STM32_DMA_STREAM_ID(1, 5)
+
 static PWMConfig pwmCFG = {
-    .frequency = 10000000, // 10MHz counter frequency
-    .period    = 2000,     // 2000 ticks period -> 5kHz PWM frequency (200us)
+    .frequency = BL_PWM_FREQUENCY, // 10MHz counter frequency
+    .period    = BL_PWM_PERIOD,    // 2000 ticks period -> 5kHz PWM frequency (200us)
     .callback  = NULL,
     .channels  = {
         {USER_PWM_MODE, NULL},
@@ -51,22 +97,157 @@ static PWMConfig pwmCFG = {
     .dier = 0
 };
 
+// Duty cycles for perceptually even steps (gamma 2.2), rising then falling so
+// a fade in either direction is one incrementing DMA transfer
+static const uint16_t bl_ramp[BL_RAMP_STEPS * 2] = {
+       0,    0,    1,    2,    5,    8,   11,   16,   21,   28,   35,   43,   52,   62,   73,   85,
+      98,  112,  127,  143,  160,  178,  198,  218,  239,  262,  285,  310,  336,  363,  391,  420,
+     451,  482,  515,  549,  584,  620,  658,  696,  736,  777,  820,  863,  908,  954, 1001, 1050,
+    1100, 1151, 1203, 1256, 1311, 1367, 1425, 1483, 1543, 1605, 1667, 1731, 1796, 1863, 1931, 2000,
+    2000, 1931, 1863, 1796, 1731, 1667, 1605, 1543, 1483, 1425, 1367, 1311, 1256, 1203, 1151, 1100,
+    1050, 1001,  954,  908,  863,  820,  777,  736,  696,  658,  620,  584,  549,  515,  482,  451,
+     420,  391,  363,  336,  310,  285,  262,  239,  218,  198,  178,  160,  143,  127,  112,   98,
+      85,   73,   62,   52,   43,   35,   28,   21,   16,   11,    8,    5,    2,    1,    0,    0,
+};
+
+static const stm32_dma_stream_t *bl_dma = NULL; // NULL if the channel was taken
+static uint8_t  bl_step = 0; // ramp step of the current backlight level
+static uint16_t bl_breath[BL_BREATH_STEPS];
+static bool     bl_breathing = false;
+static uint8_t  bl_breath_period = 0;
+
+static void bl_dma_stop(void) {
+    if (bl_dma) dmaStreamDisable(bl_dma);
+}
+
+// Feeds `count` duty values to CCR1, one per `periods` PWM periods
+static void bl_dma_start(const uint16_t *src, uint16_t count, uint16_t periods, bool circular) {
+    bl_dma_stop();
+    if (!bl_dma) {
+        // No DMA: jump to where a one-shot transfer would end
+        if (!circular) TIM1->CCR1 = src[count - 1];
+        return;
+    }
+    TIM1->RCR = periods - 1;
+    dmaStreamSetMemory0(bl_dma, src);
+    dmaStreamSetTransactionSize(bl_dma, count);
+    dmaStreamSetMode(bl_dma, STM32_DMA_CR_DIR_M2P | STM32_DMA_CR_MINC | STM32_DMA_CR_PSIZE_HWORD | STM32_DMA_CR_MSIZE_HWORD | (circular ? STM32_DMA_CR_CIRC : 0));
+    dmaStreamEnable(bl_dma);
+}
+
+// Ramp step at or just below the duty cycle on the pin, wherever a running
+// fade or breath has got to
+static uint8_t bl_current_step(void) {
+    const uint16_t duty = TIM1->CCR1;
+    uint8_t        step = 0;
+    while (step < BL_RAMP_STEPS - 1 && bl_ramp[step + 1] <= duty) step++;
+    return step;
+}
+
+static void bl_fade_to(uint8_t to) {
+    bl_dma_stop();
+    const uint8_t from = bl_current_step();
+    if (to > from) {
+        bl_dma_start(&bl_ramp[from + 1], to - from, BACKLIGHT_FADE_PERIODS, false);
+    } else if (to < from) {
+        // Falling half: step i sits at 2 * BL_RAMP_STEPS - 1 - i
+        bl_dma_start(&bl_ramp[2 * BL_RAMP_STEPS - from], from - to, BACKLIGHT_FADE_PERIODS, false);
+    } else {
+        TIM1->CCR1 = bl_ramp[to];
+    }
+}
+
 void backlight_init_ports(void) {
     palSetPadMode(GPIOA, 8, PAL_MODE_STM32_ALTERNATE_PUSHPULL);
     pwmStart(&PWMD1, &pwmCFG);
+    pwmEnableChannel(&PWMD1, 0, 0);
+
+    // No completion interrupt: the stream just stops at the end of a fade
+    bl_dma = dmaStreamAlloc(BL_DMA_STREAM, 0, NULL, NULL);
+    if (bl_dma) {
+        dmaStreamSetPeripheral(bl_dma, &TIM1->CCR1);
+        TIM1->DIER |= TIM_DIER_UDE;
+    }
 }
 
 void backlight_set(uint8_t level) {
-    if (level == 0) {
-        pwmDisableChannel(&PWMD1, 0);
-    } else if (level == 1) {
-        // Step 1: 500/2000 = 25% duty cycle
-        pwmEnableChannel(&PWMD1, 0, 500); 
-    } else {
-        // Step 2: 2000/2000 = 100% duty cycle
-        pwmEnableChannel(&PWMD1, 0, 2000);
+    if (level > BACKLIGHT_LEVELS) level = BACKLIGHT_LEVELS;
+    // Level 1 at BACKLIGHT_MIN_STEP, the top level at full duty
+    bl_step = level == 0 ? 0 : BACKLIGHT_MIN_STEP + (level - 1) * (BL_RAMP_STEPS - 1 - BACKLIGHT_MIN_STEP) / BL_LEVEL_SPAN;
+#    ifdef BACKLIGHT_BREATHING
+    if (bl_breathing) {
+        breathing_enable(); // rebuild the breath for the new peak
+        return;
     }
+#    endif
+    bl_fade_to(bl_step);
+}
+
+#    ifdef BACKLIGHT_BREATHING
+// PWM periods per breath step for the configured period, in seconds
+static uint16_t bl_breath_periods(void) {
+    uint32_t periods = (uint32_t)get_breathing_period() * BL_PWM_HZ / BL_BREATH_STEPS;
+    if (periods < 1) periods = 1;
+    if (periods > 256) periods = 256;
+    return periods;
+}
+
+// One breath from the current level down to off and back, on the ramp with
+// the steps interpolated, so breathing starts and ends at the set level
+static void bl_breath_build(void) {
+    const uint16_t last = BL_BREATH_STEPS - 1;
+    for (uint16_t k = 0; k < BL_BREATH_STEPS; k++) {
+        const uint16_t tri  = 2 * k > last ? 2 * k - last : last - 2 * k; // last .. 1 .. last
+        const uint32_t pos  = (uint32_t)bl_step * tri;                    // ramp step x last
+        const uint8_t  step = pos / last;
+        const uint16_t frac = pos % last;
+        uint16_t       duty = bl_ramp[step];
+        if (frac) duty += (uint32_t)(bl_ramp[step + 1] - duty) * frac / last;
+        bl_breath[k] = duty;
+    }
+}
+
+bool is_breathing(void) {
+    return bl_breathing;
+}
+
+void breathing_enable(void) {
+    bl_dma_stop();
+    bl_breath_build();
+    bl_breath_period = get_breathing_period();
+    bl_breathing     = true;
+    bl_dma_start(bl_breath, BL_BREATH_STEPS, bl_breath_periods(), true);
 }
 
-void backlight_task(void) {}
+void breathing_disable(void) {
+    bl_breathing = false;
+    bl_fade_to(bl_step);
+}
+
+// Finish the running breath, which ends at the set level, then stop
+void breathing_self_disable(void) {
+    if (!bl_breathing) return;
+    bl_dma_stop();
+    const uint16_t left = bl_dma ? dmaStreamGetTransactionSize(bl_dma) : 0;
+    bl_breathing        = false;
+    if (left) bl_dma_start(&bl_breath[BL_BREATH_STEPS - left], left, bl_breath_periods(), false);
+}
+
+void breathing_pulse(void) {
+    if (bl_breathing) return;
+    bl_breath_build();
+    bl_dma_start(bl_breath, BL_BREATH_STEPS, bl_breath_periods(), false);
+}
+#    endif
+
+void backlight_task(void) {
+#    ifdef BACKLIGHT_BREATHING
+    // Pick up breathing period changes; the repetition counter is preloaded,
+    // so the new pace starts on the next step
+    if (bl_breathing && bl_breath_period != get_breathing_period()) {
+        bl_breath_period = get_breathing_period();
+        TIM1->RCR        = bl_breath_periods() - 1;
+    }
+#    endif
+}
 #endif